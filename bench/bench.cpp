@@ -0,0 +1,382 @@
+// Headless benchmark of ImNodeFlow on synthetic graphs.
+// Runs ImGui without platform or renderer backend and prints one JSON object per measured graph on stdout.
+//
+// Usage: imnodeflow_bench [--shapes chain,fanout,dag,grid] [--sizes 100,1000,10000,100000] [--frames 60]
+//                         [--culling] [--batch-links] [--direct] [--lazy] [--no-draw-cache] [--threads N]
+//                         [--headless] [--pool-check]
+//
+// --headless creates no ImGui context: graphs are only built and evaluated, the frame and hit-test timings stay at zero.
+// --pool-check runs no benchmark: two editors share a ContainedContextPool and Delete is pressed in the second one,
+//              the exit code is not zero if its selected node survives.
+
+#include <chrono>
+#include <cfloat>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "imgui.h"
+#include "ImNodeFlow.h"
+
+using Clock = std::chrono::steady_clock;
+
+static double msSince(Clock::time_point t0)
+{
+    return std::chrono::duration<double, std::milli>(Clock::now() - t0).count();
+}
+
+class BenchNode : public ImFlow::BaseNode {
+public:
+    explicit BenchNode(int inputs = 1) {
+        setTitle("Bench");
+        for (int i = 0; i < inputs; i++)
+            m_ins.push_back(addIN<uint32_t>("In" + std::to_string(i), 0, ImFlow::ConnectionFilter::SameType()));
+        addOUT<uint32_t>("Out")->behaviour([this]() {
+            uint32_t sum = 1;
+            for (auto &in: m_ins)
+                sum += in->val();
+            return sum;
+        });
+    }
+
+private:
+    std::vector<std::shared_ptr<ImFlow::InPin<uint32_t>>> m_ins;
+};
+
+struct Options {
+    std::vector<std::string> shapes = {"chain", "fanout", "dag", "grid"};
+    std::vector<int> sizes = {100, 1000, 10000, 100000};
+    int frames = 60;
+    bool culling = false;
+    bool batchLinks = false;
+    bool direct = false;
+    bool lazy = false;
+    bool drawCache = true;
+    bool headless = false;
+    bool poolCheck = false;
+    unsigned threads = 0;
+};
+
+struct Result {
+    size_t links = 0;
+    double buildMs = 0.0;
+    double updateMs = 0.0, updateMaxMs = 0.0;
+    double frameMs = 0.0;
+    double evalMs = 0.0;
+    double hitTestNs = 0.0;
+    double rectQueryNs = 0.0;
+    int vertices = 0;
+};
+
+static std::vector<std::string> splitList(const char *s)
+{
+    std::vector<std::string> out;
+    std::string cur;
+    for (; *s; s++) {
+        if (*s == ',') {
+            out.push_back(cur);
+            cur.clear();
+        } else
+            cur += *s;
+    }
+    if (!cur.empty())
+        out.push_back(cur);
+    return out;
+}
+
+static void link(ImFlow::BaseNode *from, int input, ImFlow::BaseNode *to)
+{
+    to->inPin("In" + std::to_string(input))->createLink(from->outPin("Out"));
+}
+
+// Nodes are laid out row by row on a square, links follow the shape
+static size_t buildGraph(ImFlow::ImNodeFlow &inf, const std::string &shape, int count)
+{
+    const int side = (int)std::ceil(std::sqrt((double)count));
+    auto place = [side](int i) { return ImVec2((float)(i % side) * 180.f, (float)(i / side) * 100.f); };
+    int inputs = shape == "chain" || shape == "fanout" ? 1 : shape == "grid" ? 2 : 3;
+
+    std::vector<ImFlow::BaseNode *> nodes;
+    nodes.reserve((size_t)count);
+    for (int i = 0; i < count; i++)
+        nodes.push_back(inf.addNode<BenchNode>(place(i), i == 0 && shape == "fanout" ? 0 : inputs).get());
+
+    std::mt19937 rng(42);
+    for (int i = 1; i < count; i++) {
+        if (shape == "chain")
+            link(nodes[i - 1], 0, nodes[i]);
+        else if (shape == "fanout")
+            link(nodes[0], 0, nodes[i]);
+        else if (shape == "grid") {
+            if (i % side != 0)
+                link(nodes[i - 1], 0, nodes[i]);
+            if (i >= side)
+                link(nodes[i - side], 1, nodes[i]);
+        } else {
+            for (int k = 0; k < inputs && k < i; k++)
+                link(nodes[std::uniform_int_distribution<int>(0, i - 1)(rng)], k, nodes[i]);
+        }
+    }
+    return inf.getLinks().size();
+}
+
+// One ImGui frame with the editor filling the display, returns the time spent in update()
+static double frame(ImFlow::ImNodeFlow &inf, const ImVec2 &mouse, int *vertices)
+{
+    ImGuiIO &io = ImGui::GetIO();
+    io.DeltaTime = 1.f / 60.f;
+    io.AddMousePosEvent(mouse.x, mouse.y);
+
+    ImGui::NewFrame();
+    ImGui::SetNextWindowPos(ImVec2(0.f, 0.f));
+    ImGui::SetNextWindowSize(io.DisplaySize);
+    ImGui::Begin("Bench", nullptr, ImGuiWindowFlags_NoDecoration | ImGuiWindowFlags_NoSavedSettings);
+    Clock::time_point t0 = Clock::now();
+    inf.update();
+    double ms = msSince(t0);
+    ImGui::End();
+    ImGui::Render();
+
+    if (vertices)
+        *vertices = ImGui::GetDrawData()->TotalVtxCount;
+    return ms;
+}
+
+// Average time of a whole graph evaluation
+static double evaluate(ImFlow::ImNodeFlow &inf, const Options &opt)
+{
+    // Lazy mode only recomputes what was invalidated, dirty the whole graph from its first node
+    ImFlow::BaseNode *first = inf.getNodes().empty() ? nullptr : inf.getNodes()[0].second.get();
+    double ms = 0.0;
+    for (int i = 0; i < opt.frames; i++) {
+        if (opt.lazy && first)
+            first->invalidate();
+        Clock::time_point e0 = Clock::now();
+        inf.evaluate();
+        ms += msSince(e0);
+        if (opt.headless)
+            inf.updateLogic();
+    }
+    return ms / opt.frames;
+}
+
+// One ImGui frame with two editors stacked in the display
+static void poolFrame(ImFlow::ImNodeFlow &top, ImFlow::ImNodeFlow &bottom, const ImVec2 &mouse)
+{
+    ImGuiIO &io = ImGui::GetIO();
+    io.DeltaTime = 1.f / 60.f;
+    io.AddMousePosEvent(mouse.x, mouse.y);
+
+    ImGui::NewFrame();
+    ImGui::SetNextWindowPos(ImVec2(0.f, 0.f));
+    ImGui::SetNextWindowSize(io.DisplaySize);
+    ImGui::Begin("Bench", nullptr, ImGuiWindowFlags_NoDecoration | ImGuiWindowFlags_NoSavedSettings);
+    top.setSize(ImVec2(0.f, io.DisplaySize.y / 2.f));
+    top.update();
+    bottom.setSize(ImVec2(0.f, 0.f));
+    bottom.update();
+    ImGui::End();
+    ImGui::Render();
+}
+
+// The pooled context serving the second editor already saw this frame's key events while drawing the first one
+static bool poolCheck()
+{
+    ContainedContextPool pool;
+    ImFlow::ImNodeFlow top("Top"), bottom("Bottom");
+    top.getGrid().setPool(&pool);
+    bottom.getGrid().setPool(&pool);
+    top.addNode<BenchNode>(ImVec2(50.f, 50.f));
+    auto node = bottom.addNode<BenchNode>(ImVec2(50.f, 50.f));
+
+    // Clicking the empty canvas of the second editor focuses it
+    ImGuiIO &io = ImGui::GetIO();
+    ImVec2 mouse(io.DisplaySize.x / 2.f, io.DisplaySize.y * 3.f / 4.f);
+    for (int i = 0; i < 3; i++)
+        poolFrame(top, bottom, mouse);
+    io.AddMouseButtonEvent(ImGuiMouseButton_Left, true);
+    poolFrame(top, bottom, mouse);
+    io.AddMouseButtonEvent(ImGuiMouseButton_Left, false);
+    poolFrame(top, bottom, mouse);
+
+    node->selected(true);
+    poolFrame(top, bottom, mouse);
+    io.AddKeyEvent(ImGuiKey_Delete, true);
+    poolFrame(top, bottom, mouse);
+    io.AddKeyEvent(ImGuiKey_Delete, false);
+    for (int i = 0; i < 2; i++)
+        poolFrame(top, bottom, mouse);
+
+    bool ok = bottom.getNodes().size() == 0 && top.getNodes().size() == 1;
+    std::fprintf(stderr, "pool check: %s (%d contexts, %zu/%zu nodes left)\n", ok ? "ok" : "FAILED", pool.created(),
+                 top.getNodes().size(), bottom.getNodes().size());
+    return ok;
+}
+
+static Result run(const Options &opt, const std::string &shape, int count)
+{
+    Result r;
+    ImFlow::ImNodeFlow inf;
+    inf.setCulling(opt.culling);
+    inf.setLinkBatching(opt.batchLinks);
+    inf.setLazyEvaluation(opt.lazy);
+    inf.setDrawCaching(opt.drawCache);
+    inf.setEvalThreads(opt.threads);
+    inf.getGrid().config().direct_render = opt.direct;
+
+    Clock::time_point t0 = Clock::now();
+    r.links = buildGraph(inf, shape, count);
+    r.buildMs = msSince(t0);
+
+    if (opt.headless) {
+        inf.updateLogic();
+        r.evalMs = evaluate(inf, opt);
+        return r;
+    }
+
+    ImVec2 display = ImGui::GetIO().DisplaySize;
+    std::mt19937 rng(7);
+    std::uniform_real_distribution<float> mx(0.f, display.x), my(0.f, display.y);
+
+    // First frames lay the nodes out and fill the caches
+    for (int i = 0; i < 3; i++)
+        frame(inf, ImVec2(mx(rng), my(rng)), nullptr);
+
+    for (int i = 0; i < opt.frames; i++) {
+        Clock::time_point f0 = Clock::now();
+        double ms = frame(inf, ImVec2(mx(rng), my(rng)), &r.vertices);
+        r.frameMs += msSince(f0);
+        r.updateMs += ms;
+        r.updateMaxMs = std::max(r.updateMaxMs, ms);
+    }
+    r.frameMs /= opt.frames;
+    r.updateMs /= opt.frames;
+
+    r.evalMs = evaluate(inf, opt);
+
+    // Point queries over the whole graph, as done for hovering
+    ImRect bounds(FLT_MAX, FLT_MAX, -FLT_MAX, -FLT_MAX);
+    for (const ImRect &rect: inf.getNodes().column<ImFlow::NodeColumn_Rect>())
+        bounds.Add(rect);
+    std::uniform_real_distribution<float> gx(bounds.Min.x, bounds.Max.x), gy(bounds.Min.y, bounds.Max.y);
+    std::vector<ImFlow::BaseNode *> hitNodes;
+    std::vector<ImFlow::Link *> hitLinks;
+    const int queries = 10000;
+    size_t hits = 0;
+    Clock::time_point h0 = Clock::now();
+    for (int i = 0; i < queries; i++) {
+        ImVec2 p(gx(rng), gy(rng));
+        inf.getNodesIndex().query(p, hitNodes);
+        inf.getLinksIndex().query(p, hitLinks);
+        hits += hitNodes.size() + hitLinks.size();
+    }
+    r.hitTestNs = msSince(h0) * 1e6 / queries;
+
+    // Viewport-sized rectangle queries, as done for culling, streaming and link highlighting
+    Clock::time_point q0 = Clock::now();
+    for (int i = 0; i < queries / 10; i++) {
+        ImVec2 p(gx(rng), gy(rng));
+        ImRect view(p - display * 0.5f, p + display * 0.5f);
+        inf.getNodesIndex().query(view, hitNodes);
+        inf.getLinksIndex().query(view, hitLinks);
+        hits += hitNodes.size() + hitLinks.size();
+    }
+    r.rectQueryNs = msSince(q0) * 1e6 / (queries / 10);
+    if (hits == (size_t)-1)
+        std::fprintf(stderr, "\n"); // Keeps the queries from being optimized out
+    return r;
+}
+
+static bool parseOptions(int argc, char **argv, Options &opt)
+{
+    for (int i = 1; i < argc; i++) {
+        const char *a = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (!std::strcmp(a, "--shapes") && hasValue)
+            opt.shapes = splitList(argv[++i]);
+        else if (!std::strcmp(a, "--sizes") && hasValue) {
+            opt.sizes.clear();
+            for (auto &s: splitList(argv[++i]))
+                opt.sizes.push_back(std::atoi(s.c_str()));
+        } else if (!std::strcmp(a, "--frames") && hasValue)
+            opt.frames = std::max(1, std::atoi(argv[++i]));
+        else if (!std::strcmp(a, "--threads") && hasValue)
+            opt.threads = (unsigned)std::atoi(argv[++i]);
+        else if (!std::strcmp(a, "--culling"))
+            opt.culling = true;
+        else if (!std::strcmp(a, "--batch-links"))
+            opt.batchLinks = true;
+        else if (!std::strcmp(a, "--direct"))
+            opt.direct = true;
+        else if (!std::strcmp(a, "--lazy"))
+            opt.lazy = true;
+        else if (!std::strcmp(a, "--no-draw-cache"))
+            opt.drawCache = false;
+        else if (!std::strcmp(a, "--headless"))
+            opt.headless = true;
+        else if (!std::strcmp(a, "--pool-check"))
+            opt.poolCheck = true;
+        else {
+            std::fprintf(stderr, "Unknown option: %s\n", a);
+            return false;
+        }
+    }
+    for (auto &s: opt.shapes) {
+        if (s != "chain" && s != "fanout" && s != "dag" && s != "grid") {
+            std::fprintf(stderr, "Unknown shape: %s\n", s.c_str());
+            return false;
+        }
+    }
+    return true;
+}
+
+int main(int argc, char **argv)
+{
+    Options opt;
+    if (!parseOptions(argc, argv, opt))
+        return 1;
+
+    // Null renderer: the font atlas only has to be built, draw data is inspected and dropped
+    if (!opt.headless) {
+        ImGui::CreateContext();
+        ImGuiIO &io = ImGui::GetIO();
+        io.IniFilename = nullptr;
+        io.DisplaySize = ImVec2(1920.f, 1080.f);
+        unsigned char *pixels;
+        int w, h;
+        io.Fonts->GetTexDataAsRGBA32(&pixels, &w, &h);
+    }
+
+    if (opt.poolCheck && !opt.headless) {
+        bool ok = poolCheck();
+        ImGui::DestroyContext();
+        return ok ? 0 : 1;
+    }
+
+    for (auto &shape: opt.shapes) {
+        for (int count: opt.sizes) {
+            if (count <= 0)
+                continue;
+            std::fprintf(stderr, "%s %d...\n", shape.c_str(), count);
+            Result r = run(opt, shape, count);
+            std::printf("{\"shape\":\"%s\",\"nodes\":%d,\"links\":%zu,\"frames\":%d,"
+                        "\"culling\":%s,\"batch_links\":%s,\"direct\":%s,\"lazy\":%s,\"draw_cache\":%s,\"headless\":%s,\"threads\":%u,"
+                        "\"build_ms\":%.3f,\"update_ms\":%.3f,\"update_max_ms\":%.3f,\"frame_ms\":%.3f,"
+                        "\"eval_ms\":%.3f,\"hit_test_ns\":%.1f,\"rect_query_ns\":%.1f,\"vertices\":%d}\n",
+                        shape.c_str(), count, r.links, opt.frames,
+                        opt.culling ? "true" : "false", opt.batchLinks ? "true" : "false",
+                        opt.direct ? "true" : "false", opt.lazy ? "true" : "false",
+                        opt.drawCache ? "true" : "false", opt.headless ? "true" : "false", opt.threads,
+                        r.buildMs, r.updateMs, r.updateMaxMs, r.frameMs, r.evalMs, r.hitTestNs, r.rectQueryNs, r.vertices);
+            std::fflush(stdout);
+        }
+    }
+
+    if (!opt.headless)
+        ImGui::DestroyContext();
+    return 0;
+}
@@ -2,18 +2,21 @@
 
 #include "ImNodeFlow.h"
 
-class SimpleSum : public ImFlow::BaseNode {
+struct SumIn : ImFlow::PinDesc<int> { static constexpr const char* name = "In"; };
+struct SumOut : ImFlow::PinDesc<int> { static constexpr const char* name = "Out"; };
+
+class SimpleSum : public ImFlow::StaticNode<ImFlow::Inputs<SumIn>, ImFlow::Outputs<SumOut>> {
 public:
     SimpleSum() {
         setTitle("Simple sum");
         setStyle(ImFlow::NodeStyle::green());
-        ImFlow::BaseNode::addIN<int>("In", 0, ImFlow::ConnectionFilter::SameType());
-        ImFlow::BaseNode::addOUT<int>("Out", nullptr)->behaviour([this]() { return getInVal<int>("In") + m_valB; });
+        out<0>().behaviour([this]() { return in<0>().val() + m_valB; });
     }
 
     void draw() override {
         ImGui::SetNextItemWidth(100.f);
-        ImGui::InputInt("##ValB", &m_valB);
+        if (ImGui::InputInt("##ValB", &m_valB))
+            invalidate();
     }
 
 private:
@@ -11,10 +11,25 @@
 #include <algorithm>
 #include <functional>
 #include <unordered_map>
+#include <typeindex>
 #include <cstdint>
+#include <atomic>
+#include <mutex>
+#include <cfloat>
+#include <tuple>
 #include <imgui.h>
 #include "../src/imgui_bezier_math.h"
 #include "../src/context_wrapper.h"
+#include "../src/spatial_index.h"
+#include "../src/link_batch.h"
+#include "../src/thread_pool.h"
+#include "../src/slot_map.h"
+#include "../src/pool_allocator.h"
+#include "../src/binary_io.h"
+#include "../src/profiler.h"
+#include "../src/draw_cache.h"
+
+class MappedFile; // src/mapped_file.h, kept out of the public header for its system headers
 
 //#define ConnectionFilter_None       [](ImFlow::Pin* out, ImFlow::Pin* in){ return true; }
 //#define ConnectionFilter_SameType   [](ImFlow::Pin* out, ImFlow::Pin* in){ return out->getDataType() == in->getDataType(); }
@@ -25,6 +40,14 @@ namespace ImFlow
     // -----------------------------------------------------------------------------------------------------------------
     // HELPERS
 
+    /**
+     * @brief <BR>Compute the control points of smart_bezier
+     * @param p1 Starting point
+     * @param p2 Ending point
+     * @return The four points of the cubic bezier curve
+     */
+    inline static ImCubicBezierPoints smart_bezier_points(const ImVec2& p1, const ImVec2& p2);
+
     /**
      * @brief <BR>Draw a sensible bezier between two points
      * @param p1 Starting point
@@ -48,19 +71,228 @@ namespace ImFlow
      */
     inline static bool smart_bezier_collider(const ImVec2& p, const ImVec2& p1, const ImVec2& p2, float radius);
 
+    /**
+     * @brief <BR>Collider checker for smart_bezier with precomputed geometry
+     * @details Rejects the point with the bounding rectangle first, then projects it onto the curve
+     *          with an adaptive number of samples refined by Newton iterations.
+     * @param p Point to be tested
+     * @param curve Control points given by smart_bezier_points()
+     * @param bounds Bounding rectangle of the curve, already inflated by the radius
+     * @param radius Lateral width of the hit box
+     * @return [TRUE] if "p" is inside the collider
+     */
+    inline static bool smart_bezier_collider(const ImVec2& p, const ImCubicBezierPoints& curve, const ImRect& bounds, float radius);
+
+    /**
+     * @brief <BR>Distance between a point and a cubic bezier curve
+     * @details Coarse sampling with a step proportional to the length of the control polygon, followed by
+     *          Newton refinement of the closest sample. Much cheaper than ImProjectOnCubicBezier() for short curves.
+     * @param p Point to be projected
+     * @param curve Curve to be tested
+     * @return Distance between "p" and the curve
+     */
+    inline static float smart_bezier_distance(const ImVec2& p, const ImCubicBezierPoints& curve);
+
+    /**
+     * @brief Cached geometry of a smart_bezier
+     * @details Shared by the renderer and the collider of a link. Rebuilt only when one of the end points
+     *          or the zoom scale (which drives the tessellation level) changes.
+     */
+    struct LinkGeometry
+    {
+        /// @brief Control points of the curve
+        ImCubicBezierPoints curve;
+        /// @brief Tight bounding rectangle of the curve
+        ImRect bounds;
+        /// @brief Tessellated curve, ready to be drawn as a polyline
+        std::vector<ImVec2> polyline;
+
+        /**
+         * @brief <BR>Refresh the cached data
+         * @param start Starting point
+         * @param end Ending point
+         * @param scale Current zoom scale, the polyline is tessellated for the on-screen size
+         * @return [TRUE] if the geometry was rebuilt
+         */
+        inline bool update(const ImVec2& start, const ImVec2& end, float scale);
+
+        /**
+         * @brief <BR>Force the geometry to be rebuilt on the next update
+         */
+        void invalidate() { m_valid = false; }
+    private:
+        ImVec2 m_start, m_end;
+        float m_scale = 0.f;
+        float m_tessTol = 0.f;
+        bool m_valid = false;
+    };
+
     // -----------------------------------------------------------------------------------------------------------------
     // CLASSES PRE-DEFINITIONS
 
     template<typename T> class InPin;
     template<typename T> class OutPin;
     class Pin; class BaseNode;
-    class ImNodeFlow; class ConnectionFilter;
+    class ImNodeFlow; class ConnectionFilter; class Link;
 
     // -----------------------------------------------------------------------------------------------------------------
     // PIN'S PROPERTIES
 
     typedef unsigned long long int PinUID;
 
+    /**
+     * @brief <BR>64-bit FNV-1a hash, used for string pin UIDs
+     * @param s String to be hashed
+     * @param n Length of the string
+     * @return Hash of the string
+     */
+    constexpr PinUID fnv1a(const char* s, size_t n)
+    {
+        PinUID h = 14695981039346656037ull;
+        for (size_t i = 0; i < n; i++)
+            h = (h ^ (unsigned char)s[i]) * 1099511628211ull;
+        return h;
+    }
+
+    /**
+     * @brief <BR>64-bit FNV-1a hash of a null terminated string
+     * @param s String to be hashed
+     * @return Hash of the string
+     */
+    constexpr PinUID fnv1a(const char* s)
+    {
+        PinUID h = 14695981039346656037ull;
+        for (; *s; s++)
+            h = (h ^ (unsigned char)*s) * 1099511628211ull;
+        return h;
+    }
+
+    /**
+     * @brief Pre-hashed string pin UID
+     * @details Hashed at compile time when constant-evaluated: <BR>
+     *          static constexpr ImFlow::PinID In = "In"; <BR>
+     *          getInVal<int>(In);
+     */
+    struct PinID
+    {
+        constexpr PinID(const char* s) : hash(fnv1a(s)) {}
+        explicit PinID(const std::string& s) : hash(fnv1a(s.data(), s.size())) {}
+        PinUID hash;
+    };
+
+    /**
+     * @brief <BR>Hash of a generic pin UID
+     * @tparam U Type of the UID
+     * @param uid Unique identifier of the pin
+     * @return Pin UID
+     */
+    template<typename U>
+    PinUID pinHash(const U& uid) { return std::hash<U>{}(uid); }
+    inline PinUID pinHash(const std::string& uid) { return fnv1a(uid.data(), uid.size()); }
+    constexpr PinUID pinHash(const char* uid) { return fnv1a(uid); }
+    constexpr PinUID pinHash(PinID uid) { return uid.hash; }
+
+    /**
+     * @brief Small integer identifier of a pin's data type
+     * @details Handed out on first use, in no particular order. Only valid for the current run, never serialize it.
+     *          Ids come from a single counter in the library, so two types never share one. Each DLL or shared object
+     *          instantiating typeID<T>() may still give the same type its own id: the built-in filters then fall back
+     *          to comparing getDataType(), and links between pins created in different modules pay that compare.
+     */
+    typedef uint32_t TypeID;
+
+    /**
+     * @brief Set of TypeIDs, one bit per type
+     * @details Only the first 64 types handed out fit in a mask.
+     */
+    typedef uint64_t TypeMask;
+
+    /**
+     * @brief <BR>Hand out the next TypeID
+     * @details Defined in the library so that every module draws from the same counter.
+     * @return A TypeID never returned before
+     */
+    TypeID nextTypeID();
+
+    /**
+     * @brief <BR>Get the TypeID of a type
+     * @tparam T Data type
+     * @return The same TypeID for every call with the same type
+     */
+    template<typename T>
+    TypeID typeID()
+    {
+        static const TypeID id = nextTypeID();
+        return id;
+    }
+
+    /**
+     * @brief <BR>Get the mask of a set of types
+     * @tparam T Data types
+     * @return Mask with the bit of each type set, 0 if one of them doesn't fit
+     */
+    template<typename... T>
+    TypeMask typeMask()
+    {
+        if (((typeID<T>() >= 64) || ...))
+            return 0;
+        return ((TypeMask(1) << typeID<T>()) | ...);
+    }
+
+    /**
+     * @brief Sorted lookup table from pin UIDs to values
+     * @details Binary searched, a lot more compact than a hash map for the few dozens of pins of a node.
+     * @tparam V Type of the values
+     */
+    template<typename V>
+    class PinIndex
+    {
+    public:
+        /**
+         * @brief <BR>Find the value of a UID
+         * @param uid Pin UID
+         * @return Pointer to the value, nullptr if not found
+         */
+        V* find(PinUID uid)
+        {
+            auto it = lowerBound(uid);
+            return it != m_entries.end() && it->first == uid ? &it->second : nullptr;
+        }
+
+        /**
+         * @brief <BR>Add a UID, keeping the existing value if already present
+         * @param uid Pin UID
+         * @param v Value
+         */
+        void insert(PinUID uid, V v)
+        {
+            auto it = lowerBound(uid);
+            if (it == m_entries.end() || it->first != uid)
+                m_entries.insert(it, {uid, v});
+        }
+
+        /**
+         * @brief <BR>Remove a UID
+         * @param uid Pin UID
+         */
+        void erase(PinUID uid)
+        {
+            auto it = lowerBound(uid);
+            if (it != m_entries.end() && it->first == uid)
+                m_entries.erase(it);
+        }
+
+        void clear() { m_entries.clear(); }
+    private:
+        typename std::vector<std::pair<PinUID, V>>::iterator lowerBound(PinUID uid)
+        {
+            return std::lower_bound(m_entries.begin(), m_entries.end(), uid,
+                                    [](const std::pair<PinUID, V>& e, PinUID u) { return e.first < u; });
+        }
+
+        std::vector<std::pair<PinUID, V>> m_entries;
+    };
+
     /**
      * @brief Extra pin's style setting
      */
@@ -92,6 +324,10 @@ namespace ImFlow
 
         /// @brief Spacing between pin content and socket
         float socket_padding = 6.6f;
+        /// @brief Color of the ring around the socket while the value is being calculated in background
+        ImU32 pending_color = IM_COL32(255, 190, 60, 220);
+        /// @brief Color of the ring around the socket while a link that can connect to it is dragged
+        ImU32 compatible_color = IM_COL32(120, 255, 120, 200);
 
     };
 
@@ -119,6 +355,9 @@ namespace ImFlow
         /// @brief List of less common properties
         PinStyleExtras extra;
     public:
+        /// @brief <BR>Style shared by all the pins created without one. Changing it affects all of them, edit a pin's
+        ///        style through Pin::editStyle() or replace it
+        static const std::shared_ptr<PinStyle>& shared() { static std::shared_ptr<PinStyle> s = cyan(); return s; }
         /// @brief <BR>Default cyan style
         static std::shared_ptr<PinStyle> cyan() { return std::make_shared<PinStyle>(PinStyle(IM_COL32(87,155,185,255), 0, 4.f, 4.67f, 3.7f, 1.f)); }
         /// @brief <BR>Default green style
@@ -136,7 +375,75 @@ namespace ImFlow
     // -----------------------------------------------------------------------------------------------------------------
     // NODE'S PROPERTIES
 
-    typedef uintptr_t NodeUID;
+    /// @brief Generational handle of a node inside its handler
+    typedef uint64_t NodeUID;
+
+    /**
+     * @brief Per-frame node state flags kept by the handler
+     */
+    enum NodeStateFlags_
+    {
+        NodeStateFlags_None = 0,
+        NodeStateFlags_Laid = 1 << 0,
+        NodeStateFlags_Dragged = 1 << 1,
+        NodeStateFlags_Selected = 1 << 2,
+        NodeStateFlags_Hidden = 1 << 3
+    };
+
+    /**
+     * @brief Level of detail of the nodes, picked by the handler from the zoom
+     */
+    enum NodeLOD_
+    {
+        /// @brief Full layout and content
+        NodeLOD_Full,
+        /// @brief Header-colored box with socket dots, no content nor pin names
+        NodeLOD_Simple,
+        /// @brief Single filled quad
+        NodeLOD_Quad
+    };
+
+    /**
+     * @brief Side columns of the node storage
+     */
+    enum NodeColumn_
+    {
+        /// @brief Bounding rectangle in grid coordinates
+        NodeColumn_Rect,
+        /// @brief NodeStateFlags_
+        NodeColumn_Flags
+    };
+
+    /// @brief Contiguous node storage, iterated in insertion order
+    typedef SlotMap<std::shared_ptr<BaseNode>, ImRect, uint8_t> NodeStorage;
+
+    /**
+     * @brief Timings of a node, zero unless IMNODEFLOW_PROFILING is enabled
+     */
+    struct NodeProfile
+    {
+        /// @brief Whole update(): layout, pins, content and background
+        ProfileStat update;
+        /// @brief User content only (draw())
+        ProfileStat draw;
+    };
+
+    /**
+     * @brief Profiled phases of the handler's update()
+     */
+    enum ProfilePhase_
+    {
+        ProfilePhase_Async,       // Collecting asynchronous outputs
+        ProfilePhase_Begin,       // ContainedContext::begin()
+        ProfilePhase_Grid,        // Background grid
+        ProfilePhase_Stream,      // Streamed nodes and placeholders
+        ProfilePhase_Nodes,       // Nodes update and draw, deletion
+        ProfilePhase_Links,       // Links update, hit-test and draw
+        ProfilePhase_Interaction, // Link drag and drop, pop-ups
+        ProfilePhase_End,         // ContainedContext::end(), see ContextPhase_ for the details
+        ProfilePhase_Frame,       // Whole update()
+        ProfilePhase_COUNT
+    };
 
     /**
      * @brief Defines the visual appearance of a node
@@ -166,6 +473,9 @@ namespace ImFlow
         /// @brief Border thickness when selected
         float border_selected_thickness = 2.f;
     public:
+        /// @brief <BR>Style shared by all the nodes created without one. Changing it affects all of them, edit a node's
+        ///        style through BaseNode::editStyle() or replace it with BaseNode::setStyle()
+        static const std::shared_ptr<NodeStyle>& shared() { static std::shared_ptr<NodeStyle> s = cyan(); return s; }
         /// @brief <BR>Default cyan style
         static std::shared_ptr<NodeStyle> cyan() { return std::make_shared<NodeStyle>(IM_COL32(71,142,173,255), ImColor(233,241,244,255), 6.5f); }
         /// @brief <BR>Default green style
@@ -179,6 +489,15 @@ namespace ImFlow
     // -----------------------------------------------------------------------------------------------------------------
     // LINK
 
+    /**
+     * @brief Intrusive list of the links leaving an output pin
+     */
+    struct LinkList
+    {
+        Link* head = nullptr;
+        size_t count = 0;
+    };
+
     /**
      * @brief Link between two Pins of two different Nodes
      */
@@ -223,15 +542,66 @@ namespace ImFlow
          */
         [[nodiscard]] bool isHovered() const { return m_hovered; }
 
+        /**
+         * @brief <BR>Get hidden status
+         * @return [TRUE] if both ends are hidden inside the same collapsed group
+         */
+        [[nodiscard]] bool isHidden() const;
+
         /**
          * @brief <BR>Get selected status
          * @return [TRUE] If the link is selected in the current frame
          */
         [[nodiscard]] bool isSelected() const { return m_selected; }
+
+        /**
+         * @brief <BR>Get the cached geometry of the link
+         * @return Const reference to the curve, bounds and polyline of the last update
+         */
+        [[nodiscard]] const LinkGeometry& getGeometry() const { return m_geometry; }
+
+        /**
+         * @brief <BR>Insert the link at the front of the list of an output pin
+         * @details The link leaves the list on its own when destroyed.
+         * @param list List of the output pin
+         */
+        void attach(LinkList* list);
+
+        /**
+         * @brief <BR>Remove the link from the list it is in
+         */
+        void detach();
+
+        /**
+         * @brief <BR>Get the next link leaving the same output pin
+         * @return Pointer to the next link, nullptr at the end of the list
+         */
+        [[nodiscard]] Link* next() const { return m_next; }
+
+        /**
+         * @brief <BR>Set the position of the link in the handler's table
+         * @param index Index in the table
+         */
+        void setTableIndex(size_t index) { m_tableIndex = index; }
+
+        /**
+         * @brief <BR>Get the position of the link in the handler's table
+         * @return Index in the table
+         */
+        [[nodiscard]] size_t getTableIndex() const { return m_tableIndex; }
+
+        /// @brief Lateral width of the link's hit box
+        static constexpr float HitRadius = 2.5f;
     private:
         Pin* m_left;
         Pin* m_right;
         ImNodeFlow* m_inf;
+        LinkList* m_list = nullptr;
+        Link* m_prev = nullptr;
+        Link* m_next = nullptr;
+        size_t m_tableIndex = 0;
+        LinkGeometry m_geometry;
+        ImRect m_indexedRect;
         bool m_hovered = false;
         bool m_selected = false;
     };
@@ -250,6 +620,12 @@ namespace ImFlow
         ImU32 grid = IM_COL32(200, 200, 200, 40);
         /// @brief Secondary lines
         ImU32 subGrid = IM_COL32(200, 200, 200, 10);
+        /// @brief Nodes and links waiting to be streamed in
+        ImU32 placeholder = IM_COL32(200, 200, 200, 25);
+        /// @brief Fill of the box selection
+        ImU32 box_selection = IM_COL32(100, 150, 250, 40);
+        /// @brief Border of the box selection
+        ImU32 box_selection_border = IM_COL32(100, 150, 250, 160);
     };
 
     /**
@@ -261,6 +637,10 @@ namespace ImFlow
         float grid_size = 50.f;
         /// @brief Sub-grid divisions for Node snapping
         float grid_subdivisions = 5.f;
+        /// @brief Zoom below which nodes are drawn as NodeLOD_Simple
+        float lod_simple_zoom = 0.5f;
+        /// @brief Zoom below which nodes are drawn as NodeLOD_Quad
+        float lod_quad_zoom = 0.35f;
         /// @brief ImNodeFlow colors
         InfColors colors;
     };
@@ -298,6 +678,71 @@ namespace ImFlow
          */
         void update();
 
+        /**
+         * @brief <BR>Logic-only counterpart of update()
+         * @details Polls background evaluations, finishes streamed loads, and removes destroyed nodes and links. It makes no
+         *          ImGui call and needs no ImGui context, so graphs can be loaded and evaluated headless. Call it in
+         *          place of update(), never both. Nodes are not laid out or drawn and draw() is never called, so pins
+         *          shown from draw() with showIN() / showOUT() don't exist.
+         */
+        void updateLogic();
+
+        /**
+         * @brief <BR>Evaluate all the output pins of the graph
+         * @details Nodes are sorted in dependency levels following the links. The outputs of each level, static and
+         *          dynamic, are resolved in parallel, so behaviours must not call ImGui. Nodes that are part of a cycle
+         *          are resolved last, on the calling thread. Call it before update() to have the frame read cached
+         *          values only.
+         */
+        void evaluate();
+
+        /**
+         * @brief <BR>Set the number of threads used by evaluate()
+         * @param threads Number of threads, calling thread included. 0 picks the hardware concurrency
+         */
+        void setEvalThreads(unsigned threads) { m_evalPool.setThreadCount(threads); }
+
+        /**
+         * @brief <BR>Get the number of threads used by evaluate()
+         * @return Number of threads, calling thread included
+         */
+        [[nodiscard]] unsigned getEvalThreads() const { return m_evalPool.threadCount(); }
+
+        /**
+         * @brief <BR>Set the number of background threads used by asynchronous output pins
+         * @param threads Number of threads
+         */
+        void setAsyncThreads(unsigned threads) { m_asyncExecutor.setThreadCount(threads); }
+
+        /**
+         * @brief <BR>Get the executor running asynchronous output pins
+         * @return Reference to the background executor
+         */
+        AsyncExecutor& getAsyncExecutor() { return m_asyncExecutor; }
+
+        /**
+         * @brief <BR>Queue the start of a background evaluation
+         * @details Thread-safe, called by asynchronous output pins from whichever thread resolves them, evaluate()
+         *          workers included. The task is only submitted, and the pin polled, once update() or updateLogic()
+         *          flush the queue on the UI thread.
+         * @param pin Pointer to the pin
+         * @param task Work to run on the background executor
+         */
+        void queueAsync(Pin* pin, std::function<void()> task);
+
+        /**
+         * @brief <BR>Poll a pin each frame until its background evaluation completes
+         * @details UI thread only, see queueAsync() for the other threads.
+         * @param pin Pointer to the pin
+         */
+        void watchAsync(Pin* pin) { m_asyncPins.push_back(pin); }
+
+        /**
+         * @brief <BR>Stop polling a pin and drop its queued evaluation
+         * @param pin Pointer to the pin
+         */
+        void unwatchAsync(Pin* pin);
+
         /**
          * @brief <BR>Add a node to the grid
          * @tparam T Derived class of <BaseNode> to be added
@@ -364,12 +809,104 @@ namespace ImFlow
         template<typename T, typename... Params>
         std::shared_ptr<T> placeNode(Params&&... args);
 
+        /**
+         * @brief <BR>Register a node type for serialization
+         * @details Saved graphs refer to node types by the hash of their name, so names must not change between
+         *          versions of the application.
+         * @tparam T Derived class of <BaseNode>, must be default constructible
+         * @param name Name of the type
+         */
+        template<typename T>
+        void registerNodeType(const std::string& name);
+
+        /**
+         * @brief <BR>Serialize the graph
+         * @details Saves the type, position and user data of the nodes, and the links between them.
+         *          Nodes of unregistered types are skipped along with their links.
+         * @param out Writer the graph is appended to
+         */
+        void save(BinaryWriter& out);
+
+        /**
+         * @brief <BR>Serialize the graph to a file
+         * @param path Path of the file, overwritten
+         * @return [TRUE] if the file was written
+         */
+        bool saveFile(const std::string& path);
+
+        /**
+         * @brief <BR>Add a serialized graph to the editor
+         * @details Bulk load: containers are sized up front, links are resolved in a single pass and connected without
+         *          running the connection filters or invalidating nodes. Nodes of unknown types are skipped along
+         *          with their links. <BR>
+         *          Links to pins missing after loading, e.g. dynamic pins, are retried by update(). A link still missing
+         *          a pin after the first update that ran draw() on both of its nodes is dropped and counted by
+         *          getDroppedLinks().
+         * @param in Reader positioned at the start of the graph
+         * @return [FALSE] if the data is malformed. The nodes read up to that point are kept
+         */
+        bool load(BinaryReader& in);
+
+        /**
+         * @brief <BR>Get the number of loaded links dropped because one of their pins never appeared
+         * @return Links dropped since the handler was created
+         */
+        [[nodiscard]] size_t getDroppedLinks() const { return m_droppedLinks; }
+
+        /**
+         * @brief <BR>Add a serialized graph to the editor from a memory-mapped file
+         * @param path Path of the file
+         * @return [FALSE] if the file can't be opened or is malformed
+         */
+        bool loadFile(const std::string& path);
+
+        /**
+         * @brief <BR>Add a serialized graph to the editor over the next frames
+         * @details Only the records are read up front. Each update() then creates a few nodes, closest to the visible
+         *          area first, and connects their links as soon as both ends exist. Nodes not created yet are drawn as
+         *          placeholder rectangles. A stream already running is finished first.
+         * @param data Serialized graph, owned by the stream
+         * @return [FALSE] if the data is malformed
+         */
+        bool stream(std::vector<char> data);
+
+        /**
+         * @brief <BR>Stream a serialized graph from a memory-mapped file
+         * @param path Path of the file
+         * @return [FALSE] if the file can't be opened or is malformed
+         */
+        bool streamFile(const std::string& path);
+
+        /**
+         * @brief <BR>Create all the nodes left in the stream at once
+         */
+        void finishStream();
+
+        /**
+         * @brief <BR>Set how many streamed nodes are created per frame
+         * @param nodes Number of nodes
+         */
+        void setStreamBudget(size_t nodes) { m_streamBudget = nodes == 0 ? 1 : nodes; }
+
+        /**
+         * @brief <BR>Get the number of nodes waiting to be streamed in
+         * @return Number of nodes not created yet
+         */
+        [[nodiscard]] size_t getStreamPending() const { return m_stream ? m_stream->remaining : 0; }
+
         /**
          * @brief <BR>Add link to the handler internal list
          * @param link Reference to the link
          */
         void addLink(std::shared_ptr<Link>& link);
 
+        /**
+         * @brief <BR>Remove a link from the handler's table
+         * @details Leaves a hole that is compacted at the end of update(), so links can go away while being iterated.
+         * @param link Pointer to the link
+         */
+        void removeLink(Link* link);
+
         /**
          * @brief <BR>Pop-up when link is "dropped"
          * @details Sets the content of a pop-up that can be displayed when dragging a link in the open instead of onto another pin.
@@ -427,7 +964,7 @@ namespace ImFlow
          * @brief <BR>Get editor's list of nodes
          * @return Const reference to editor's internal nodes list
          */
-        std::unordered_map<NodeUID, std::shared_ptr<BaseNode>>& getNodes() { return m_nodes; }
+        NodeStorage& getNodes() { return m_nodes; }
 
         /**
          * @brief <BR>Get nodes count
@@ -439,7 +976,7 @@ namespace ImFlow
          * @brief <BR>Get editor's list of links
          * @return Const reference to editor's internal links list
          */
-        const std::vector<std::weak_ptr<Link>>& getLinks() { return m_links; }
+        const std::vector<Link*>& getLinks() { compactLinks(); return m_links; }
 
         /**
          * @brief <BR>Get zooming viewport
@@ -453,6 +990,23 @@ namespace ImFlow
          */
         [[nodiscard]] bool isNodeDragged() const { return m_draggingNode; }
 
+        /**
+         * @brief <BR>Check if the editor has to be drawn again
+         * @details Set by anything that changes what the editor shows: scroll and zoom (including the smooth zoom
+         *          animation), node dragging, selection and hovering, links being created, dragged or deleted, nodes
+         *          being added or removed, pins being invalidated, pending async results and streamed nodes.
+         *          Cleared at the start of update(). Input is not tracked: a host throttling its frame rate must still
+         *          run a frame when ImGui receives events.
+         * @return [TRUE] if the last update() changed something, or something changed since then
+         */
+        [[nodiscard]] bool needsRedraw() const { return m_dirty; }
+
+        /**
+         * @brief <BR>Request a redraw
+         * @details For changes the handler can't see, e.g. the content of a node changing outside of update().
+         */
+        void markDirty() { m_dirty = true; }
+
         /**
          * @brief <BR>Get current style
          * @return Reference to style variables
@@ -473,6 +1027,60 @@ namespace ImFlow
          */
         void draggingNode(bool state) { m_draggingNodeNext = state; }
 
+        /**
+         * @brief <BR>Get the selected nodes
+         * @return Handles of the selected nodes, in no particular order
+         */
+        [[nodiscard]] const std::vector<NodeUID>& getSelection() const { return m_selection; }
+
+        /**
+         * @brief <BR>Deselect all the nodes
+         * @details Like BaseNode::selected(), takes effect at the end of the nodes update.
+         */
+        void clearSelection();
+
+        /**
+         * @brief <BR>Select all the nodes overlapping a rectangle
+         * @details Like BaseNode::selected(), takes effect at the end of the nodes update.
+         * @param rect Rectangle in grid coordinates
+         */
+        void selectRect(const ImRect& rect);
+
+        /**
+         * @brief <BR>Get box selection status
+         * @return [TRUE] while a selection rectangle is being dragged on free space
+         */
+        [[nodiscard]] bool isBoxSelecting() const { return m_boxSelecting; }
+
+        /**
+         * @brief <BR>Collect the pins a pin could be linked to
+         * @details Only the nodes overlapping the area are visited, through the nodes index. Hidden nodes are skipped.
+         * @param dragged Pin the link starts from
+         * @param area Rectangle in grid coordinates
+         * @param out Destination of the compatible pins, cleared first
+         */
+        void compatiblePins(Pin* dragged, const ImRect& area, std::vector<Pin*>& out);
+
+        /**
+         * @brief <BR>Get the highlight epoch of the current frame
+         * @details Pins highlighted with this value draw a ring around their socket. Bumped at the start of each update.
+         * @return Current highlight epoch
+         */
+        [[nodiscard]] unsigned int getHighlightEpoch() const { return m_highlightEpoch; }
+
+        /**
+         * @brief <BR>Queue the selection change of a node
+         * @details Called by BaseNode::selected(), the selection is updated at the end of the nodes update.
+         * @param node Node whose selection state changes
+         */
+        void selectionChanged(BaseNode* node);
+
+        /**
+         * @brief <BR>Get the level of detail of the nodes for the current frame
+         * @return One of NodeLOD_
+         */
+        [[nodiscard]] int getLOD() const { return m_lod; }
+
         /**
          * @brief <BR>Set what pin is being hovered
          * @param hovering Pointer to the hovered pin
@@ -512,33 +1120,401 @@ namespace ImFlow
         bool on_free_space();
 
         /**
-         * @brief <BR>Get recursion blacklist for nodes
-         * @return Reference to blacklist
+         * @brief <BR>Enable or disable viewport culling
+         * @details When enabled, nodes that were outside of the visible canvas on the previous frame skip layout and
+         *          rendering. They still run a logic-only update so selection, deletion and dragging stay consistent.
+         * @param state New culling state
          */
-        std::vector<std::string>& get_recursion_blacklist() { return m_pinRecursionBlacklist; }
-    private:
-        std::string m_name;
-        ContainedContext m_context;
+        void setCulling(bool state) { m_culling = state; }
 
-        bool m_singleUseClick = false;
+        /**
+         * @brief <BR>Get culling status
+         * @return [TRUE] if viewport culling is enabled
+         */
+        [[nodiscard]] bool isCulling() const { return m_culling; }
 
-        std::unordered_map<NodeUID, std::shared_ptr<BaseNode>> m_nodes;
-        std::vector<std::string> m_pinRecursionBlacklist;
-        std::vector<std::weak_ptr<Link>> m_links;
+        /**
+         * @brief <BR>Get the timing of a phase of the last update()
+         * @param phase One of ProfilePhase_
+         * @return Time and calls, zero unless IMNODEFLOW_PROFILING is enabled
+         */
+        [[nodiscard]] const ProfileStat& getProfile(int phase) const { return m_profile[phase]; }
 
-        std::function<void(Pin* dragged)> m_droppedLinkPopUp;
-        ImGuiKey m_droppedLinkPupUpComboKey = ImGuiKey_None;
-        Pin* m_droppedLinkLeft = nullptr;
-        std::function<void(BaseNode* node)> m_rightClickPopUp;
-        BaseNode* m_hoveredNodeAux = nullptr;
+        /**
+         * @brief <BR>Reset the accumulated timings of all the nodes and pins
+         */
+        void resetProfile();
 
-        BaseNode* m_hoveredNode = nullptr;
-        bool m_draggingNode = false, m_draggingNodeNext = false;
-        Pin* m_hovering = nullptr;
-        Pin* m_dragOut = nullptr;
+        /**
+         * @brief <BR>Tint the header of the nodes by the time they took to update on the previous frame
+         * @param state New heatmap state
+         */
+        void setProfileHeatmap(bool state) { m_profileHeatmap = state; }
 
-        InfStyler m_style;
-    };
+        /**
+         * @brief <BR>Get heatmap status
+         * @return [TRUE] if the node headers are tinted by cost
+         */
+        [[nodiscard]] bool isProfileHeatmap() const { return m_profileHeatmap; }
+
+        /**
+         * @brief <BR>Get the update time of the slowest node on the previous frame
+         * @return Time in seconds
+         */
+        [[nodiscard]] double getProfileMaxNodeTime() const { return m_profileMaxNode; }
+
+        /**
+         * @brief <BR>Draw a window with the timings of the last frame and the slowest nodes
+         * @details Must be called outside of update().
+         * @param open Optional pointer to the visibility flag of the window
+         */
+        void drawProfiler(bool* open = nullptr);
+
+        /**
+         * @brief <BR>Get the visible portion of the grid
+         * @return Rectangle in grid coordinates of the area visible in the current frame
+         */
+        [[nodiscard]] const ImRect& getVisibleRect() const { return m_visibleRect; }
+
+        /**
+         * @brief <BR>Enable or disable batched link rendering
+         * @details When enabled, links are collected during the frame and written into the draw list as a single
+         *          block of vertices instead of one or two polylines per link.
+         * @param state New batching state
+         */
+        void setLinkBatching(bool state) { m_batchLinks = state; }
+
+        /**
+         * @brief <BR>Get link batching status
+         * @return [TRUE] if links are rendered in a single batch
+         */
+        [[nodiscard]] bool isLinkBatching() const { return m_batchLinks; }
+
+        /**
+         * @brief <BR>Enable or disable draw caching
+         * @details When enabled, the grid and the node backgrounds are recorded once and their vertices replayed on
+         *          the next frames, until the scroll, zoom, size or style they were drawn with changes.
+         * @param state New caching state
+         */
+        void setDrawCaching(bool state) { m_drawCaching = state; }
+
+        /**
+         * @brief <BR>Get draw caching status
+         * @return [TRUE] if the grid and node backgrounds are replayed from cache
+         */
+        [[nodiscard]] bool isDrawCaching() const { return m_drawCaching; }
+
+        /**
+         * @brief <BR>Get the batch links are queued into
+         * @return Reference to the link batch of the current frame
+         */
+        LinkBatch& getLinkBatch() { return m_linkBatch; }
+
+        /**
+         * @brief <BR>Enable or disable lazy evaluation
+         * @details When enabled, output pins cache their value and only run their behaviour after being invalidated,
+         *          either by a change of the links upstream or explicitly through BaseNode::invalidate().
+         * @param state New lazy evaluation state
+         */
+        void setLazyEvaluation(bool state);
+
+        /**
+         * @brief <BR>Get lazy evaluation status
+         * @return [TRUE] if output values are only recalculated when invalidated
+         */
+        [[nodiscard]] bool isLazyEvaluation() const { return m_lazy; }
+
+        /**
+         * @brief <BR>Update the position of a node in the spatial index
+         * @param node Pointer to the node
+         * @param rect Bounding rectangle of the node in grid coordinates
+         */
+        void updateNodeIndex(BaseNode* node, const ImRect& rect) { m_nodesIndex.update(node, rect); }
+
+        /**
+         * @brief <BR>Remove a node from the spatial index
+         * @param node Pointer to the node
+         */
+        void removeNodeIndex(BaseNode* node) { m_nodesIndex.remove(node); }
+
+        /**
+         * @brief <BR>Update the position of a link in the spatial index
+         * @param link Pointer to the link
+         * @param rect Bounding rectangle of the link in grid coordinates
+         */
+        void updateLinkIndex(Link* link, const ImRect& rect) { m_linksIndex.update(link, rect); }
+
+        /**
+         * @brief <BR>Update the per-frame state of a node
+         * @param uid Handle of the node
+         * @param rect Bounding rectangle of the node in grid coordinates
+         * @param flags NodeStateFlags_ of the node
+         */
+        void updateNodeState(NodeUID uid, const ImRect& rect, uint8_t flags);
+
+        /**
+         * @brief <BR>Remove a link from the spatial index
+         * @param link Pointer to the link
+         */
+        void removeLinkIndex(Link* link) { m_linksIndex.remove(link); }
+
+        /**
+         * @brief <BR>Get the spatial index of the nodes
+         * @return Const reference to the index of nodes bounding rectangles in grid coordinates
+         */
+        const SpatialIndex<BaseNode*>& getNodesIndex() const { return m_nodesIndex; }
+
+        /**
+         * @brief <BR>Get the spatial index of the links
+         * @return Const reference to the index of links bounding rectangles in grid coordinates
+         */
+        const SpatialIndex<Link*>& getLinksIndex() const { return m_linksIndex; }
+
+        /**
+         * @brief <BR>Get the evaluation epoch
+         * @details Output pins evaluate at most once per epoch. The epoch advances at the end of each update().
+         * @return Current evaluation epoch, never 0
+         */
+        [[nodiscard]] unsigned long long getEvalEpoch() const { return m_evalEpoch; }
+
+        /**
+         * @brief <BR>Start a new evaluation epoch
+         * @details Lets custom evaluators force a fresh evaluation outside of update().
+         */
+        void nextEvalEpoch() { m_evalEpoch++; }
+    private:
+        /**
+         * @brief <BR>Remove the holes left in the link table
+         */
+        void compactLinks();
+
+        /**
+         * @brief Node record of a serialized graph
+         */
+        struct GraphNode
+        {
+            uint64_t type;
+            ImRect rect;
+            const char* payload;
+            uint32_t payloadSize;
+            NodeUID uid = 0;
+            bool created = false;
+        };
+
+        /**
+         * @brief Link record of a serialized graph
+         */
+        struct GraphLink
+        {
+            uint32_t from;
+            PinUID out;
+            uint32_t to;
+            PinUID in;
+        };
+
+        /**
+         * @brief Parsed serialized graph
+         * @details Payloads point into the source data, which the stream keeps alive while it runs.
+         */
+        struct GraphStream
+        {
+            std::shared_ptr<MappedFile> file; // Shared, not unique, so that MappedFile can stay incomplete here
+            std::vector<char> buffer;
+            std::vector<GraphNode> nodes;
+            std::vector<GraphLink> links;
+            std::vector<uint32_t> linkStart, linkIds;
+            std::vector<uint32_t> pending; // In reverse file order, so that nodes are popped from the back
+            SpatialIndex<uint32_t> index; // Nodes not created yet
+            std::vector<uint32_t> visible; // Scratch list of the pending nodes in view
+            size_t remaining = 0;
+        };
+
+        /**
+         * @brief <BR>Read the records of a serialized graph
+         * @param in Reader positioned at the start of the graph
+         * @param graph Destination of the records
+         * @return [FALSE] if the data is malformed
+         */
+        bool parseGraph(BinaryReader& in, GraphStream& graph);
+
+        /**
+         * @brief <BR>Start streaming a parsed graph
+         * @param graph Stream owning the data
+         * @param data Start of the serialized graph
+         * @param size Size of the serialized graph
+         * @return [FALSE] if the data is malformed
+         */
+        bool beginStream(std::unique_ptr<GraphStream> graph, const void* data, size_t size);
+
+        /**
+         * @brief <BR>Create a node of a parsed graph
+         * @details When the graph is streamed, also connects the links of the node whose other end already exists.
+         * @param graph Parsed graph
+         * @param i Index of the node record
+         */
+        void createGraphNode(GraphStream& graph, uint32_t i);
+
+        /**
+         * @brief <BR>Connect a link of a parsed graph if both its ends exist
+         * @details Links whose pins are not there yet, e.g. dynamic pins, are kept until draw() shows the pins,
+         *          see load().
+         * @param graph Parsed graph
+         * @param link Link record
+         */
+        void connectGraphLink(GraphStream& graph, const GraphLink& link);
+
+        /// @brief Loaded link waiting for its pins
+        struct DeferredLink
+        {
+            NodeUID from;
+            PinUID out;
+            NodeUID to;
+            PinUID in;
+        };
+
+        /**
+         * @brief <BR>Try to connect a loaded link
+         * @param link Ends of the link
+         * @return [TRUE] if done with the link: connected, or one of its nodes is gone
+         */
+        bool connectDeferred(const DeferredLink& link);
+
+        /**
+         * @brief <BR>Create a pending node of the stream and take it out of the pending set
+         * @param graph Running stream
+         * @param i Index of the node
+         */
+        void streamNode(GraphStream& graph, uint32_t i);
+
+        /**
+         * @brief <BR>Create the streamed nodes closest to the visible area and draw the placeholders of the others
+         * @param draw_list Draw list of the canvas
+         */
+        void updateStream(ImDrawList* draw_list);
+
+        /**
+         * @brief <BR>Apply the queued selection changes and drop the nodes about to be destroyed from the selection
+         */
+        void applySelection();
+
+        /**
+         * @brief <BR>Remove the destroyed nodes from the storage and the index
+         */
+        void eraseDestroyed();
+
+        /**
+         * @brief <BR>Collect the completed background evaluations, then submit the queued ones
+         */
+        void pollAsync();
+
+        /**
+         * @brief <BR>Submit the background evaluations queued by queueAsync()
+         */
+        void flushAsync();
+
+        /**
+         * @brief <BR>Remove a node from the selection
+         * @param node Selected node
+         */
+        void dropSelection(BaseNode* node);
+
+        /**
+         * @brief <BR>Move all the selected nodes by the mouse delta while a node is dragged
+         */
+        void updateSelectionDrag();
+
+        /**
+         * @brief <BR>Start, draw and apply the box selection
+         * @param draw_list Draw list of the canvas
+         */
+        void updateBoxSelection(ImDrawList* draw_list);
+
+        typedef std::function<std::shared_ptr<BaseNode>(const ImVec2& pos)> NodeFactory;
+        std::unordered_map<uint64_t, NodeFactory> m_nodeFactories;
+        std::unordered_map<std::type_index, uint64_t> m_nodeTypeIds;
+        std::unique_ptr<GraphStream> m_stream;
+        std::vector<DeferredLink> m_deferredLinks;
+        size_t m_droppedLinks = 0;
+        size_t m_streamBudget = 64;
+
+        std::string m_name;
+        ContainedContext m_context;
+
+        bool m_singleUseClick = false;
+        bool m_dirty = true;
+
+        // Declared before the containers so they outlive the nodes and links they index
+        SpatialIndex<BaseNode*> m_nodesIndex;
+        SpatialIndex<Link*> m_linksIndex;
+        std::vector<BaseNode*> m_queryNodes;
+        std::vector<Link*> m_queryLinks;
+        std::vector<Pin*> m_asyncPins;
+        std::vector<std::pair<Pin*, std::function<void()>>> m_asyncQueue, m_asyncSubmit;
+        std::mutex m_asyncQueueMutex;
+        std::vector<Link*> m_links;
+        bool m_linksHoles = false;
+
+        NodeStorage m_nodes;
+        unsigned long long m_evalEpoch = 1;
+
+        std::vector<NodeUID> m_selection;
+        std::vector<NodeUID> m_selectionChanges;
+        bool m_boxSelecting = false;
+        ImVec2 m_boxStart;
+
+        std::function<void(Pin* dragged)> m_droppedLinkPopUp;
+        ImGuiKey m_droppedLinkPupUpComboKey = ImGuiKey_None;
+        Pin* m_droppedLinkLeft = nullptr;
+        std::function<void(BaseNode* node)> m_rightClickPopUp;
+        BaseNode* m_hoveredNodeAux = nullptr;
+
+        BaseNode* m_hoveredNode = nullptr;
+        bool m_draggingNode = false, m_draggingNodeNext = false;
+        Pin* m_hovering = nullptr;
+        Pin* m_dragOut = nullptr;
+        std::vector<Pin*> m_compatiblePins;
+        unsigned int m_highlightEpoch = 0;
+
+        bool m_culling = false;
+        ImRect m_visibleRect;
+        int m_lod = NodeLOD_Full;
+
+        bool m_batchLinks = false;
+        LinkBatch m_linkBatch;
+
+        /**
+         * @brief What the cached grid depends on, compared bytewise
+         * @details Only 4-byte members so that there is no padding. Lines are recorded relative to the canvas origin.
+         */
+        struct GridKey
+        {
+            ImVec2 size, scroll, uv;
+            float step, subdivisions, fringe;
+            ImU32 grid, subGrid;
+            int subGridVisible, flags;
+        };
+        bool m_drawCaching = true;
+        DrawCache m_gridCache;
+        GridKey m_gridKey{};
+
+        bool m_lazy = false;
+
+        ProfileStat m_profile[ProfilePhase_COUNT];
+        bool m_profileHeatmap = false;
+        double m_profileMaxNode = 0.0, m_profileFrameMax = 0.0;
+
+        ThreadPool m_evalPool;
+        // Declared after the nodes so running tasks are waited for before the nodes go away
+        AsyncExecutor m_asyncExecutor;
+        // Evaluation scratch, indexed by dense node index and kept between calls for its capacity
+        std::vector<int> m_evalInDegree;
+        std::vector<uint32_t> m_evalLinkFrom, m_evalLinkTo;
+        std::vector<uint32_t> m_evalStart, m_evalDownstream;
+        std::vector<uint32_t> m_evalLevel, m_evalNext;
+        std::vector<Pin*> m_evalPins;
+
+        InfStyler m_style;
+    };
 
     // -----------------------------------------------------------------------------------------------------------------
     // BASE NODE
@@ -550,7 +1526,7 @@ namespace ImFlow
     class BaseNode
     {
     public:
-        virtual ~BaseNode() = default;
+        virtual ~BaseNode() { m_destroyed = true; } // Pins being destroyed must not invalidate a dying node
         BaseNode() = default;
 
         /**
@@ -559,6 +1535,37 @@ namespace ImFlow
          */
         void update();
 
+        /**
+         * @brief <BR>Logic-only loop of the node
+         * @details Used in place of update() when the node is culled. Skips layout and rendering but keeps
+         *          selection, deletion and dragging up to date, and moves the pins along with the node.
+         */
+        void updateCulled();
+
+        /**
+         * @brief <BR>Reduced loop of the node when zoomed out
+         * @details Used in place of update() below the LOD zooms of the handler's style, once the node was laid out.
+         *          Draws the last known rectangle without calling draw() or laying out the pins, but keeps
+         *          selection, deletion and dragging working. Links can still be dragged from the sockets in
+         *          NodeLOD_Simple.
+         * @param lod One of NodeLOD_
+         */
+        void updateLOD(int lod);
+
+        /**
+         * @brief <BR>Check if the node can be culled
+         * @param view Visible area in grid coordinates
+         * @return [TRUE] if the node was laid out at least once and its last known rectangle is outside the view
+         */
+        [[nodiscard]] bool isCullable(const ImRect& view) const;
+
+        /**
+         * @brief <BR>Mark all the outputs of the node as changed
+         * @details Only relevant in lazy evaluation mode. Call it when something read by the behaviours changes
+         *          outside of the inputs (e.g. a widget in draw()). Propagates downstream through the links.
+         */
+        void invalidate();
+
         /**
          * @brief <BR>Content of the node
          * @details Function to be implemented by derived custom nodes.
@@ -566,6 +1573,21 @@ namespace ImFlow
          */
         virtual void draw() {}
 
+        /**
+         * @brief <BR>Write the node's user data
+         * @details Function to be implemented by derived custom nodes with state to be saved.
+         *          Position and links are saved by the handler.
+         * @param out Writer of the graph
+         */
+        virtual void serialize(BinaryWriter& out) const {}
+
+        /**
+         * @brief <BR>Read the node's user data
+         * @details Counterpart of serialize(). Called after the node is constructed and added to the grid.
+         * @param in Reader limited to the data written by serialize()
+         */
+        virtual void deserialize(BinaryReader& in) {}
+
         /**
          * @brief <BR>Add an Input to the node
          * @details Will add an Input pin to the node with the given name and data type.
@@ -739,6 +1761,16 @@ namespace ImFlow
         template<typename T>
         const T& getInVal(const char* uid);
 
+        /**
+         * @brief <BR>Get Input value from an InPin
+         * @details Get a reference to the value of an input pin, the value is stored in the output pin at the other end of the link.
+         * @tparam T Data type
+         * @param uid Pre-hashed unique identifier of the pin
+         * @return Const reference to the value
+         */
+        template<typename T>
+        const T& getInVal(PinID uid);
+
         /**
          * @brief <BR>Get generic reference to input pin
          * @tparam U Type of the UID
@@ -755,6 +1787,13 @@ namespace ImFlow
          */
         Pin* inPin(const char* uid);
 
+        /**
+         * @brief <BR>Get generic reference to input pin
+         * @param uid Pre-hashed unique identifier of the pin
+         * @return Generic pointer to the pin
+         */
+        Pin* inPin(PinID uid);
+
         /**
          * @brief <BR>Get generic reference to output pin
          * @tparam U Type of the UID
@@ -771,6 +1810,13 @@ namespace ImFlow
          */
         Pin* outPin(const char* uid);
 
+        /**
+         * @brief <BR>Get generic reference to output pin
+         * @param uid Pre-hashed unique identifier of the pin
+         * @return Generic pointer to the pin
+         */
+        Pin* outPin(PinID uid);
+
         /**
          * @brief <BR>Get internal input pins list
          * @return Const reference to node's internal list
@@ -783,10 +1829,58 @@ namespace ImFlow
          */
         const std::vector<std::shared_ptr<Pin>>& getOuts() { return m_outs; }
 
+        /**
+         * @brief <BR>Get dynamic input pins list
+         * @return Const reference to the dynamic inputs, paired with the frames they still have to live
+         */
+        const std::vector<std::pair<int, std::shared_ptr<Pin>>>& getDynamicIns() { return m_dynamicIns; }
+
+        /**
+         * @brief <BR>Get dynamic output pins list
+         * @return Const reference to the dynamic outputs, paired with the frames they still have to live
+         */
+        const std::vector<std::pair<int, std::shared_ptr<Pin>>>& getDynamicOuts() { return m_dynamicOuts; }
+
+        /**
+         * @brief <BR>Find an input by hashed UID
+         * @param uid Hashed UID, see pinHash()
+         * @return Pointer to the pin, nullptr if not found
+         */
+        Pin* findIn(PinUID uid) { Pin** p = m_insIndex.find(uid); return p ? *p : nullptr; }
+
+        /**
+         * @brief <BR>Find an output by hashed UID
+         * @param uid Hashed UID, see pinHash()
+         * @return Pointer to the pin, nullptr if not found
+         */
+        Pin* findOut(PinUID uid) { Pin** p = m_outsIndex.find(uid); return p ? *p : nullptr; }
+
+        /**
+         * @brief <BR>Find a dynamic input by hashed UID
+         * @details Dynamic pins only exist while draw() keeps showing them.
+         * @param uid Hashed UID, see pinHash()
+         * @return Pointer to the pin, nullptr if not found
+         */
+        Pin* findDynamicIn(PinUID uid) { size_t* i = m_dynamicInsIndex.find(uid); return i ? m_dynamicIns[*i].second.get() : nullptr; }
+
+        /**
+         * @brief <BR>Find a dynamic output by hashed UID
+         * @details Dynamic pins only exist while draw() keeps showing them.
+         * @param uid Hashed UID, see pinHash()
+         * @return Pointer to the pin, nullptr if not found
+         */
+        Pin* findDynamicOut(PinUID uid) { size_t* i = m_dynamicOutsIndex.find(uid); return i ? m_dynamicOuts[*i].second.get() : nullptr; }
+
+        /**
+         * @brief <BR>Check if draw() ran during the current update of the handler
+         * @return [FALSE] if the node was hidden, culled or drawn at a lower level of detail
+         */
+        [[nodiscard]] bool drawnThisFrame() const { return m_inf && m_drawnEpoch == m_inf->getHighlightEpoch(); }
+
         /**
          * @brief <BR>Delete itself
          */
-        void destroy() { m_destroyed = true; }
+        virtual void destroy() { m_destroyed = true; }
 
         /*
          * @brief <BR>Get if node must be deleted
@@ -837,10 +1931,24 @@ namespace ImFlow
 
         /**
          * @brief <BR>Get node's style
+         * @details Nodes created without a style all point to NodeStyle::shared(): editing it through this pointer
+         *          restyles all of them. Use editStyle() or setStyle() to change this node only.
          * @return Shared pointer to the node's style
          */
         const std::shared_ptr<NodeStyle>& getStyle() { return m_style; }
 
+        /**
+         * @brief <BR>Get node's style for editing
+         * @details A node still using NodeStyle::shared() gets its own copy first, so only this node changes.
+         * @return Shared pointer to the node's style
+         */
+        const std::shared_ptr<NodeStyle>& editStyle()
+        {
+            if (m_style == NodeStyle::shared())
+                m_style = std::make_shared<NodeStyle>(*m_style);
+            return m_style;
+        }
+
         /**
          * @brief <BR>Get selected status
          * @return [TRUE] if the node is selected
@@ -863,22 +1971,23 @@ namespace ImFlow
          * @brief <BR>Set node's name
          * @param name New title
          */
-        BaseNode* setTitle(const std::string& title) { m_title = title; return this; }
+        BaseNode* setTitle(const std::string& title) { m_title = title; m_titleText.reset(); return this; }
 
         /**
          * @brief <BR>Set node's position
          * @param pos Position in grid coordinates
          */
-        BaseNode* setPos(const ImVec2& pos) { m_pos = pos; m_posTarget = pos; return this; }
+        BaseNode* setPos(const ImVec2& pos) { m_pos = pos; m_posTarget = pos; updateIndex(); return this; }
 
         /**
          * @brief <BR>Set ImNodeFlow handler
          * @param inf Grid handler for the node
          */
-        BaseNode* setHandler(ImNodeFlow* inf) { m_inf = inf; return this; }
+        BaseNode* setHandler(ImNodeFlow* inf);
 
         /**
          * @brief Set node's style
+         * @details The style is shared, not copied: nodes given the same pointer change together.
          * @param style New style
          */
         BaseNode* setStyle(std::shared_ptr<NodeStyle> style) { m_style = std::move(style); return this; }
@@ -889,28 +1998,249 @@ namespace ImFlow
          *
          * Status only updates when updatePublicStatus() is called
          */
-        BaseNode* selected(bool state) { m_selectedNext = state; return this; }
+        BaseNode* selected(bool state);
 
         /**
          * @brief <BR>Update the isSelected status of the node
+         * @details Called by the handler for the nodes whose selection changed. A deselected node stops being dragged.
+         */
+        void updatePublicStatus() { m_selected = m_selectedNext; m_dragged &= m_selected; }
+
+        /**
+         * @brief <BR>Set the position of the node in the handler's selection
+         * @param index Position in ImNodeFlow::getSelection()
          */
-        void updatePublicStatus() { m_selected = m_selectedNext; }
+        void setSelectionIndex(size_t index) { m_selectionIndex = index; }
+
+        /**
+         * @brief <BR>Get the position of the node in the handler's selection
+         * @return Position in ImNodeFlow::getSelection(), only meaningful while selected
+         */
+        [[nodiscard]] size_t getSelectionIndex() const { return m_selectionIndex; }
+
+        /**
+         * @brief <BR>Apply a dragging delta to the node, snapping it to the sub-grid
+         * @param delta Movement in grid coordinates
+         * @param release [TRUE] on the last frame of the drag
+         */
+        virtual void dragBy(const ImVec2& delta, bool release);
+
+        /**
+         * @brief <BR>Hide the node inside a collapsed group
+         * @details Hidden nodes skip update, drawing and hit-testing, and leave the selection.
+         * @param group Outermost collapsed group containing the node, nullptr to show it again
+         */
+        void setHiddenBy(BaseNode* group);
+
+        /**
+         * @brief <BR>Get the collapsed group hiding the node
+         * @return Outermost collapsed group containing the node, nullptr if visible
+         */
+        [[nodiscard]] BaseNode* getHiddenBy() const { return m_hiddenBy; }
+
+        /**
+         * @brief <BR>Get hidden status
+         * @return [TRUE] if the node is inside a collapsed group
+         */
+        [[nodiscard]] bool isHidden() const { return m_hiddenBy != nullptr; }
+
+        /**
+         * @brief <BR>Get node's timings
+         * @return Const reference to the timings of the node, see getOuts() for the evaluation of its outputs
+         */
+        [[nodiscard]] const NodeProfile& getProfile() const { return m_profile; }
+
+        /**
+         * @brief <BR>Reset the timings of the node and its pins
+         */
+        void resetProfile();
+    protected:
+        /**
+         * @brief <BR>List a pin stored by the node itself
+         * @details The pin is listed and indexed like the ones of addIN() and addOUT(), but not allocated nor owned:
+         *          it must live as long as the node. Used by StaticNode.
+         * @param pin Input or output pin whose parent is this node
+         */
+        void attachPin(Pin* pin);
+
+        /**
+         * @brief <BR>Get the handler slot given to the pins of the node
+         * @return Address of the node's handler pointer
+         */
+        ImNodeFlow** handlerSlot() { return &m_inf; }
+
+        /**
+         * @brief <BR>Translate all the pins by the movement of the node since its last layout
+         * @details Called when the node is not laid out, i.e. culled or drawn at a lower level of detail.
+         */
+        virtual void followPins();
     private:
+        /**
+         * @brief <BR>Push the node's rectangle to the handler's spatial index if it changed
+         */
+        void updateIndex();
+
+        /**
+         * @brief <BR>Find a pin by UID
+         * @param index Index of the list
+         * @param h Pin UID
+         * @return Pointer to the pin, asserts if not found
+         */
+        static Pin* findPin(PinIndex<Pin*>& index, PinUID h);
+
+        /**
+         * @brief <BR>Remove a pin from a list and its index
+         * @param pins List of pins
+         * @param index Index of the list
+         * @param h Pin UID
+         */
+        static void dropPin(std::vector<std::shared_ptr<Pin>>& pins, PinIndex<Pin*>& index, PinUID h);
+
+        /**
+         * @brief <BR>Rebuild the index of a list of dynamic pins
+         * @param pins List of dynamic pins
+         * @param index Index of the list
+         */
+        static void indexDynamic(const std::vector<std::pair<int, std::shared_ptr<Pin>>>& pins, PinIndex<size_t>& index);
+
         NodeUID m_uid = 0;
         std::string m_title;
+        TextCache m_titleText;
         ImVec2 m_pos, m_posTarget;
         ImVec2 m_size;
         ImVec2 m_fullSize;
+        ImVec2 m_layoutOrigin;
+        unsigned int m_drawnEpoch = 0; // Highlight epoch of the last update that ran draw()
+        float m_headerHeight = 0.f;
+        /**
+         * @brief What the cached background depends on, compared bytewise
+         * @details Only 4-byte members so that there is no padding. Rects are recorded relative to the node origin.
+         */
+        struct BackgroundKey
+        {
+            ImVec2 size, paddingTL, paddingBR, uv;
+            float headerH, radius, thickness, fringe;
+            ImU32 bg, headerBg, border;
+            int flags;
+        };
+        DrawCache m_bgCache;
+        BackgroundKey m_bgKey{};
+        ImRect m_indexedRect = {0.f, 0.f, -1.f, -1.f};
         ImNodeFlow* m_inf = nullptr;
         std::shared_ptr<NodeStyle> m_style;
         bool m_selected = false, m_selectedNext = false;
         bool m_dragged = false;
         bool m_destroyed = false;
+        size_t m_selectionIndex = 0;
+        BaseNode* m_hiddenBy = nullptr;
+        NodeProfile m_profile;
 
         std::vector<std::shared_ptr<Pin>> m_ins;
         std::vector<std::pair<int, std::shared_ptr<Pin>>> m_dynamicIns;
         std::vector<std::shared_ptr<Pin>> m_outs;
         std::vector<std::pair<int, std::shared_ptr<Pin>>> m_dynamicOuts;
+        PinIndex<Pin*> m_insIndex;
+        PinIndex<Pin*> m_outsIndex;
+        PinIndex<size_t> m_dynamicInsIndex;
+        PinIndex<size_t> m_dynamicOutsIndex;
+    };
+
+    // -----------------------------------------------------------------------------------------------------------------
+    // GROUP NODE
+
+    /**
+     * @brief Node grouping other nodes of the same handler
+     * @details Members stay regular nodes of the handler, so links and evaluation flow through the group untouched.
+     *          While collapsed the members are hidden: they skip update, drawing and hit-testing, the links between
+     *          them are skipped and the ones leaving the group are drawn from its edges. Exposed pins of the members
+     *          are laid out on the collapsed group and can be connected like its own.
+     *          Dragging the group moves its members, destroying it destroys them.
+     */
+    class GroupNode : public BaseNode
+    {
+    public:
+        explicit GroupNode(const std::string& title = "Group") { setTitle(title); }
+
+        /**
+         * @brief <BR>Add a node to the group
+         * @param node Node of the same handler, not already in a group
+         */
+        GroupNode* addMember(BaseNode* node);
+
+        /**
+         * @brief <BR>Take a node out of the group
+         * @details The node is shown again if the group was collapsed, its exposed pins are dropped.
+         * @param node Member of the group
+         */
+        GroupNode* removeMember(BaseNode* node);
+
+        /**
+         * @brief <BR>Show an input of a member on the collapsed group
+         * @param node Member of the group, or of a group inside it
+         * @param uid Input pin UID
+         */
+        GroupNode* exposeIn(BaseNode* node, PinUID uid) { m_exposedIns.emplace_back(node->getUID(), uid); return this; }
+
+        /**
+         * @brief <BR>Show an output of a member on the collapsed group
+         * @param node Member of the group, or of a group inside it
+         * @param uid Output pin UID
+         */
+        GroupNode* exposeOut(BaseNode* node, PinUID uid) { m_exposedOuts.emplace_back(node->getUID(), uid); return this; }
+
+        /**
+         * @brief <BR>Collapse or expand the group
+         * @param state [TRUE] to hide the members
+         */
+        GroupNode* collapse(bool state);
+
+        /**
+         * @brief <BR>Get collapsed status
+         * @return [TRUE] if the members are hidden
+         */
+        [[nodiscard]] bool isCollapsed() const { return m_collapsed; }
+
+        /**
+         * @brief <BR>Get the members
+         * @return Handles of the members, destroyed ones are dropped on the next update of the group
+         */
+        [[nodiscard]] const std::vector<NodeUID>& getMembers() const { return m_members; }
+
+        void draw() override;
+        void destroy() override;
+        void dragBy(const ImVec2& delta, bool release) override;
+    protected:
+        void followPins() override;
+    private:
+        /**
+         * @brief <BR>Hide or show the members, recursively through the groups inside
+         * @param by Collapsed group hiding this one, nullptr if it is visible
+         */
+        void hideMembers(BaseNode* by);
+
+        /**
+         * @brief <BR>Move the pins of all the hidden members to the edges of the group
+         */
+        void placeHiddenPins();
+
+        /**
+         * @brief <BR>Lay out and update the exposed pins of the members, dropping the ones that no longer exist
+         * @param pins Exposed pins
+         * @param inputs [TRUE] for input pins
+         */
+        void layoutExposed(std::vector<std::pair<NodeUID, PinUID>>& pins, bool inputs);
+
+        /**
+         * @brief <BR>Call a function on the members still in the handler
+         * @param f Function to be called
+         * @param recursive [TRUE] to also visit the members of the groups inside
+         */
+        void forEachMember(const std::function<void(BaseNode*)>& f, bool recursive);
+
+        std::vector<NodeUID> m_members;
+        std::vector<std::pair<NodeUID, PinUID>> m_exposedIns, m_exposedOuts;
+        bool m_collapsed = false;
+        ImVec2 m_pinsOrigin = {FLT_MAX, FLT_MAX};
     };
 
     // -----------------------------------------------------------------------------------------------------------------
@@ -944,7 +2274,7 @@ namespace ImFlow
             :m_uid(uid), m_name(std::move(name)), m_type(kind), m_parent(parent), m_inf(inf), m_style(std::move(style))
             {
                 if(!m_style)
-                    m_style = PinStyle::cyan();
+                    m_style = PinStyle::shared();
             }
 
         virtual ~Pin() = default;
@@ -965,11 +2295,34 @@ namespace ImFlow
          */
         void drawDecoration();
 
+        /**
+         * @brief <BR>Draw the socket as a plain square dot, for zoomed-out nodes
+         * @return [TRUE] if the mouse is hovering the socket
+         */
+        bool drawDot();
+
         /**
          * @brief <BR>Used by output pins to calculate their values
          */
         virtual void resolve() {}
 
+        /**
+         * @brief <BR>Used by output pins to mark their cached value as outdated
+         */
+        virtual void invalidate() {}
+
+        /**
+         * @brief <BR>Used by output pins to collect the result of a background evaluation
+         * @return [TRUE] if the evaluation is still running
+         */
+        virtual bool pollAsync() { return false; }
+
+        /**
+         * @brief <BR>Get pending status
+         * @return [TRUE] if the value carried by the pin is outdated and being calculated in background
+         */
+        [[nodiscard]] virtual bool isPending() { return false; }
+
         /**
          * @brief <BR>Custom render function to override Pin appearance
          * @param r Function or lambda expression with new ImGui rendering
@@ -982,6 +2335,20 @@ namespace ImFlow
          */
         virtual void createLink(Pin* other) = 0;
 
+        /**
+         * @brief <BR>Check if a link between the pins would be accepted, without creating it
+         * @param other Pointer to the other pin
+         * @return [TRUE] if createLink() with the pin would connect them
+         */
+        virtual bool canConnect(Pin* other) { return false; }
+
+        /**
+         * @brief <BR>Connect to a pin without any check or notification
+         * @details Used when loading a saved graph. Only inputs restore links.
+         * @param other Pointer to the output pin
+         */
+        virtual void restoreLink(Pin* other) {}
+
         /**
          * @brief <BR>Set the reference to a link
          * @param link Smart pointer to the link
@@ -1047,12 +2414,38 @@ namespace ImFlow
          */
         [[nodiscard]] virtual const std::type_info& getDataType() const = 0;
 
+        /**
+         * @brief <BR>Get pin's data type ID
+         * @return TypeID of \<T>, cheaper to compare than getDataType()
+         */
+        [[nodiscard]] TypeID getTypeID() const { return m_typeId; }
+
+        /**
+         * @brief <BR>Highlight the socket for the current frame
+         * @param epoch Current highlight epoch of the handler
+         */
+        void highlight(unsigned int epoch) { m_highlight = epoch; }
+
         /**
          * @brief <BR>Get pin's style
+         * @details Pins created without a style all point to PinStyle::shared(): editing it through this pointer
+         *          restyles all of them. Use editStyle(), or assign a new style, to change this pin only.
          * @return Smart pointer to pin's style
          */
         std::shared_ptr<PinStyle>& getStyle() { return m_style; }
 
+        /**
+         * @brief <BR>Get pin's style for editing
+         * @details A pin still using PinStyle::shared() gets its own copy first, so only this pin changes.
+         * @return Smart pointer to pin's style
+         */
+        std::shared_ptr<PinStyle>& editStyle()
+        {
+            if (m_style == PinStyle::shared())
+                m_style = std::make_shared<PinStyle>(*m_style);
+            return m_style;
+        }
+
         /**
          * @brief <BR>Get pin's link attachment point (socket)
          * @return Grid coordinates to the attachment point between the link and the pin's socket
@@ -1063,13 +2456,24 @@ namespace ImFlow
          * @brief <BR>Calculate pin's width pre-rendering
          * @return The with of the pin once it will be rendered
          */
-        float calcWidth() { return ImGui::CalcTextSize(m_name.c_str()).x; }
+        float calcWidth() { return m_nameText.size(m_name).x; }
 
         /**
          * @brief <BR>Set pin's position
          * @param pos Position in screen coordinates
          */
         void setPos(ImVec2 pos) { m_pos = pos; }
+
+        /**
+         * @brief <BR>Get pin's evaluation timing
+         * @return Time and calls of the output behaviour, zero for inputs or unless IMNODEFLOW_PROFILING is enabled
+         */
+        [[nodiscard]] const ProfileStat& getProfile() const { return m_profile; }
+
+        /**
+         * @brief <BR>Reset pin's evaluation timing
+         */
+        void resetProfile() { m_profile.reset(); }
     protected:
         PinUID m_uid;
         std::string m_name;
@@ -1080,6 +2484,10 @@ namespace ImFlow
         ImNodeFlow** m_inf;
         std::shared_ptr<PinStyle> m_style;
         std::function<void(Pin* p)> m_renderer;
+        ProfileStat m_profile;
+        TypeID m_typeId = 0;
+        unsigned int m_highlight = 0;
+        TextCache m_nameText;
     };
 
     /**
@@ -1088,9 +2496,22 @@ namespace ImFlow
     class ConnectionFilter
     {
     public:
-        static std::function<bool(Pin*, Pin*)> None() { return [](Pin* out, Pin* in){ return true; }; }
-        static std::function<bool(Pin*, Pin*)> SameType() { return [](Pin* out, Pin* in) { return out->getDataType() == in->getDataType(); }; }
-        static std::function<bool(Pin*, Pin*)> Numbers() { return [](Pin* out, Pin* in){ return out->getDataType() == typeid(double) || out->getDataType() == typeid(float) || out->getDataType() == typeid(int); }; }
+        static std::function<bool(Pin*, Pin*)> None() { return &any; }
+        static std::function<bool(Pin*, Pin*)> SameType() { return &sameType; }
+        static std::function<bool(Pin*, Pin*)> Numbers() { return &numbers; }
+
+        /// @brief Built-in filters, recognized by InPin and checked without calling through the std::function
+        static bool any(Pin* out, Pin* in) { return true; }
+        static bool sameType(Pin* out, Pin* in) { return out->getTypeID() == in->getTypeID() || out->getDataType() == in->getDataType(); }
+        static bool numbers(Pin* out, Pin* in)
+        {
+            TypeID id = out->getTypeID();
+            if (id == typeID<double>() || id == typeID<float>() || id == typeID<int>())
+                return true;
+            // The pin may come from another module, with its own ids
+            const std::type_info& t = out->getDataType();
+            return t == typeid(double) || t == typeid(float) || t == typeid(int);
+        }
     };
 
     /**
@@ -1111,7 +2532,11 @@ namespace ImFlow
          * @param style Style of the pin
          */
         explicit InPin(PinUID uid, const std::string& name, T defReturn, std::function<bool(Pin*, Pin*)> filter, std::shared_ptr<PinStyle> style, BaseNode* parent, ImNodeFlow** inf)
-            : Pin(uid, name, style, PinType_Input, parent, inf), m_emptyVal(defReturn), m_filter(std::move(filter)) {}
+            : Pin(uid, name, style, PinType_Input, parent, inf), m_emptyVal(defReturn), m_filter(std::move(filter))
+            {
+                m_typeId = typeID<T>();
+                classifyFilter();
+            }
 
         /**
          * @brief <BR>Create link between pins
@@ -1119,10 +2544,31 @@ namespace ImFlow
          */
         void createLink(Pin* other) override;
 
+        /**
+         * @brief <BR>Check if a link between the pins would be accepted, without creating it
+         * @param other Pointer to the other pin
+         * @return [TRUE] if createLink() with the pin would connect them
+         */
+        bool canConnect(Pin* other) override;
+
+        /**
+         * @brief <BR>Run the connection filter
+         * @details The built-in filters are checked with a compare or a mask test, only custom ones call the std::function.
+         * @param out Pointer to the output pin
+         * @return [TRUE] if the filter lets the output through
+         */
+        bool accepts(Pin* out);
+
+        /**
+         * @brief <BR>Connect to an output without running the filter or invalidating the node
+         * @param other Pointer to the output pin
+         */
+        void restoreLink(Pin* other) override;
+
         /**
         * @brief <BR>Delete the link connected to the pin
         */
-        void deleteLink() override { m_link.reset(); }
+        void deleteLink() override { m_link.reset(); m_source = nullptr; m_parent->invalidate(); }
 
         /**
          * @brief Specify if connections from an output on the same node are allowed
@@ -1160,6 +2606,12 @@ namespace ImFlow
          */
         ImVec2 pinPoint() override { return m_pos + ImVec2(-m_style->extra.socket_padding, m_size.y / 2); }
 
+        /**
+         * @brief <BR>Get pending status
+         * @return [TRUE] if the connected output is being calculated in background
+         */
+        [[nodiscard]] bool isPending() override { return m_link && m_link->left()->isPending(); }
+
         /**
          * @brief <BR>Get value carried by the connected link
          * @return Reference to the value of the connected OutPin. Or the default value if not connected
@@ -1167,9 +2619,20 @@ namespace ImFlow
         const T& val();
     private:
         std::shared_ptr<Link> m_link;
+        OutPin<T>* m_source = nullptr;
         T m_emptyVal;
         std::function<bool(Pin*, Pin*)> m_filter;
         bool m_allowSelfConnection = false;
+
+        /// @brief How the filter is checked, set once from the filter given to the constructor
+        enum FilterKind { FilterKind_Custom, FilterKind_Any, FilterKind_SameType, FilterKind_Mask };
+        FilterKind m_filterKind = FilterKind_Custom;
+        TypeMask m_filterMask = 0;
+
+        /**
+         * @brief <BR>Recognize the built-in filters
+         */
+        void classifyFilter();
     };
 
     /**
@@ -1189,14 +2652,14 @@ namespace ImFlow
          * @param style Style of the pin
          */
         explicit OutPin(PinUID uid, const std::string& name, std::shared_ptr<PinStyle> style, BaseNode* parent, ImNodeFlow** inf)
-            :Pin(uid, name, style, PinType_Output, parent, inf) {}
+            :Pin(uid, name, style, PinType_Output, parent, inf) { m_typeId = typeID<T>(); }
 
         /**
          * @brief <BR>When parent gets deleted, remove the links
          */
         ~OutPin() override {
-            std::vector<std::weak_ptr<Link>> links = std::move(m_links);
-            for (auto &l: links) if (!l.expired()) l.lock()->right()->deleteLink();
+            if (m_inFlight) (*m_inf)->unwatchAsync(this);
+            while (Link* l = m_links.head) { l->detach(); l->right()->deleteLink(); }
         }
 
         /**
@@ -1205,6 +2668,13 @@ namespace ImFlow
          */
         void createLink(Pin* other) override;
 
+        /**
+         * @brief <BR>Check if a link between the pins would be accepted, without creating it
+         * @param other Pointer to the other pin
+         * @return [TRUE] if createLink() with the pin would connect them
+         */
+        bool canConnect(Pin* other) override { return other != this && other->getType() == PinType_Input && other->canConnect(this); }
+
         /**
          * @brief <BR>Add a connected link to the internal list
          * @param link Pointer to the link
@@ -1212,15 +2682,21 @@ namespace ImFlow
         void setLink(std::shared_ptr<Link>& link) override;
 
         /**
-         * @brief <BR>Delete any expired weak pointers to a (now deleted) link
+         * @brief <BR>Nothing to do: links leave the list on their own when destroyed
          */
-        void deleteLink() override;
+        void deleteLink() override {}
 
         /**
          * @brief <BR>Get connected status
          * @return [TRUE] is pin is connected to one or more links
          */
-        bool isConnected() override { return !m_links.empty(); }
+        bool isConnected() override { return m_links.count != 0; }
+
+        /**
+         * @brief <BR>Get the links leaving the pin
+         * @return Const reference to the intrusive list, walk it with Link::next()
+         */
+        [[nodiscard]] const LinkList& getLinks() const { return m_links; }
 
         /**
          * @brief <BR>Get pin's link attachment point (socket)
@@ -1239,7 +2715,73 @@ namespace ImFlow
          * @details Used to define the pin behaviour. This is what gets the data from the parent's inputs, and applies the needed logic.
          * @param func Function or lambda expression used to calculate output value
          */
-        OutPin<T>* behaviour(std::function<T()> func) { m_behaviour = std::move(func); return this; }
+        OutPin<T>* behaviour(std::function<T()> func) { m_behaviour = std::move(func); m_inPlaceBehaviour = nullptr; invalidate(); return this; }
+
+        /**
+         * @brief <BR>Set logic to calculate output value in place
+         * @details Same as behaviour(), but the function writes straight into the value of the pin. Useful for big
+         *          types, whose storage can be reused from one evaluation to the next.
+         * @param func Function or lambda expression used to write the output value
+         */
+        OutPin<T>* inPlaceBehaviour(std::function<void(T&)> func) { m_inPlaceBehaviour = std::move(func); m_behaviour = nullptr; invalidate(); return this; }
+
+        /**
+         * @brief <BR>Set logic to calculate output value in background
+         * @details The function runs on the thread calling val(), which is an evaluate() worker when the graph is
+         *          evaluated in parallel. It gathers the inputs and returns the task doing the actual work, which is
+         *          handed to the handler's background executor by the next update() or updateLogic(). Until the result
+         *          is collected there, val() keeps returning the previous value and the pin is pending.
+         * @param func Function or lambda expression returning the task that calculates the output value
+         */
+        OutPin<T>* asyncBehaviour(std::function<std::function<T()>()> func)
+        {
+            m_asyncBehaviour = std::move(func);
+            if (!m_slot) m_slot = std::make_shared<AsyncSlot>();
+            invalidate();
+            return this;
+        }
+
+        /**
+         * @brief <BR>Collect the result of a background evaluation
+         * @details Swaps the completed value in and invalidates the nodes downstream.
+         * @return [TRUE] if the evaluation is still running
+         */
+        bool pollAsync() override;
+
+        /**
+         * @brief <BR>Get pending status
+         * @return [TRUE] if a background evaluation is running or about to be started
+         */
+        [[nodiscard]] bool isPending() override { return m_asyncBehaviour && (m_inFlight || m_dirty); }
+
+        /**
+         * @brief <BR>Mark the cached value as outdated
+         * @details Propagates to the nodes connected downstream. Stops at pins that are already outdated.
+         */
+        void invalidate() override;
+
+        /**
+         * @brief <BR>Get dirty status
+         * @return [TRUE] if the value will be recalculated on the next val() in lazy evaluation mode
+         */
+        [[nodiscard]] bool isDirty() const { return m_dirty; }
+
+        /**
+         * @brief <BR>Get the epoch of the last evaluation
+         * @return Evaluation epoch in which the behaviour last ran, 0 if never
+         */
+        [[nodiscard]] unsigned long long getEvalEpoch() const { return m_epoch; }
+
+        /**
+         * @brief <BR>Calculate the output value
+         */
+        void resolve() override { val(); }
+
+        /**
+         * @brief <BR>Get evaluation status
+         * @return [TRUE] while the behaviour is running, a val() in this state comes from a cycle
+         */
+        [[nodiscard]] bool isEvaluating() const { return m_evaluating; }
 
         /**
          * @brief <BR>Get pin's data type (aka: \<T>)
@@ -1247,9 +2789,161 @@ namespace ImFlow
          */
         [[nodiscard]] const std::type_info& getDataType() const override { return typeid(T); };
     private:
-        std::vector<std::weak_ptr<Link>> m_links;
+        /// @brief Back buffer written by the background task, at most one task writes it at a time
+        struct AsyncSlot
+        {
+            T value;
+            std::atomic<bool> ready{false};
+        };
+
+        /**
+         * @brief <BR>Run the behaviour into the value of the pin
+         */
+        void compute();
+
+        /**
+         * @brief <BR>Start a background evaluation if needed
+         * @return Const reference to the last completed value
+         */
+        const T& asyncVal();
+
+        LinkList m_links;
         std::function<T()> m_behaviour;
+        std::function<void(T&)> m_inPlaceBehaviour;
+        std::function<std::function<T()>()> m_asyncBehaviour;
+        std::shared_ptr<AsyncSlot> m_slot;
+        bool m_inFlight = false;
         T m_val;
+        bool m_dirty = true;
+        bool m_evaluating = false;
+        unsigned long long m_epoch = 0;
+    };
+
+    // -----------------------------------------------------------------------------------------------------------------
+    // STATIC NODE
+
+    /**
+     * @brief Compile-time pin descriptor
+     * @details Derive from it and add the name of the pin: <BR>
+     *          struct SumIn : ImFlow::PinDesc<int> { static constexpr const char* name = "In"; }; <BR>
+     *          def(), filter() and style() can be redeclared in the descriptor to change the defaults.
+     * @tparam T Type of the pin's value
+     */
+    template<typename T>
+    struct PinDesc
+    {
+        using type = T;
+        static T def() { return T{}; }
+        static std::function<bool(Pin*, Pin*)> filter() { return ConnectionFilter::SameType(); }
+        static std::shared_ptr<PinStyle> style() { return nullptr; }
+    };
+
+    /**
+     * @brief List of input pin descriptors of a StaticNode
+     */
+    template<typename... D>
+    struct Inputs {};
+
+    /**
+     * @brief List of output pin descriptors of a StaticNode
+     */
+    template<typename... D>
+    struct Outputs {};
+
+    /**
+     * @brief Input pin built from a descriptor
+     * @tparam D PinDesc of the pin
+     */
+    template<typename D>
+    class StaticIn : public InPin<typename D::type>
+    {
+    public:
+        static constexpr PinUID uid = fnv1a(D::name);
+
+        explicit StaticIn(const std::pair<BaseNode*, ImNodeFlow**>& parent)
+            : InPin<typename D::type>(uid, D::name, D::def(), D::filter(), D::style(), parent.first, parent.second) {}
+    };
+
+    /**
+     * @brief Output pin built from a descriptor
+     * @tparam D PinDesc of the pin
+     */
+    template<typename D>
+    class StaticOut : public OutPin<typename D::type>
+    {
+    public:
+        static constexpr PinUID uid = fnv1a(D::name);
+
+        explicit StaticOut(const std::pair<BaseNode*, ImNodeFlow**>& parent)
+            : OutPin<typename D::type>(uid, D::name, D::style(), parent.first, parent.second) {}
+    };
+
+    template<typename In, typename Out>
+    class StaticNode;
+
+    /**
+     * @brief Node whose pins are known at compile time
+     * @details The pins are stored inside the node instead of being allocated one by one, their UIDs are constant
+     *          and in<N>() / out<N>() reach them without any lookup. They are still listed by getIns() and
+     *          getOuts(), so links, evaluation and serialization treat them like any other pin. <BR>
+     *          class Sum : public ImFlow::StaticNode<ImFlow::Inputs<SumA, SumB>, ImFlow::Outputs<SumOut>> <BR>
+     *          { public: Sum() { out<0>().behaviour([this]() { return in<0>().val() + in<1>().val(); }); } };
+     * @tparam I Input PinDesc
+     * @tparam O Output PinDesc
+     */
+    template<typename... I, typename... O>
+    class StaticNode<Inputs<I...>, Outputs<O...>> : public BaseNode
+    {
+        // One per pin, each pin is built in place from it
+        template<typename>
+        using Parent = std::pair<BaseNode*, ImNodeFlow**>;
+    public:
+        StaticNode() : m_staticIns(Parent<I>(this, handlerSlot())...), m_staticOuts(Parent<O>(this, handlerSlot())...)
+        {
+            std::apply([this](auto&... p) { (attachPin(&p), ...); }, m_staticIns);
+            std::apply([this](auto&... p) { (attachPin(&p), ...); }, m_staticOuts);
+        }
+
+        // The pins go before the node, links being removed must not invalidate it
+        ~StaticNode() override { BaseNode::destroy(); }
+
+        StaticNode(const StaticNode&) = delete;
+        StaticNode& operator=(const StaticNode&) = delete;
+
+        /**
+         * @brief <BR>Get an input pin
+         * @tparam N Index in the Inputs list
+         * @return Reference to the pin
+         */
+        template<size_t N>
+        auto& in() { return std::get<N>(m_staticIns); }
+
+        /**
+         * @brief <BR>Get an output pin
+         * @tparam N Index in the Outputs list
+         * @return Reference to the pin
+         */
+        template<size_t N>
+        auto& out() { return std::get<N>(m_staticOuts); }
+
+        /**
+         * @brief <BR>Get the UID of an input pin
+         * @tparam N Index in the Inputs list
+         * @return Pin UID, the hash of its name
+         */
+        template<size_t N>
+        static constexpr PinUID inUid() { return std::tuple_element_t<N, std::tuple<StaticIn<I>...>>::uid; }
+
+        /**
+         * @brief <BR>Get the UID of an output pin
+         * @tparam N Index in the Outputs list
+         * @return Pin UID, the hash of its name
+         */
+        template<size_t N>
+        static constexpr PinUID outUid() { return std::tuple_element_t<N, std::tuple<StaticOut<O>...>>::uid; }
+    private:
+        std::tuple<StaticIn<I>...> m_staticIns;
+        std::tuple<StaticOut<O>...> m_staticOuts;
     };
 }
 
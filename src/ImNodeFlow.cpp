@@ -1,6 +1,12 @@
 #include "ImNodeFlow.h"
+#include "mapped_file.h"
 
 namespace ImFlow {
+    TypeID nextTypeID() {
+        static std::atomic<TypeID> next{0};
+        return next.fetch_add(1, std::memory_order_relaxed);
+    }
+
     // -----------------------------------------------------------------------------------------------------------------
     // LINK
 
@@ -9,11 +15,24 @@ namespace ImFlow {
         ImVec2 end = m_right->pinPoint();
         float thickness = m_left->getStyle()->extra.link_thickness;
         bool mouseClickState = m_inf->getSingleUseClick();
+        bool wasHovered = m_hovered, wasSelected = m_selected;
 
         if (!ImGui::IsKeyDown(ImGuiKey_LeftCtrl) && ImGui::IsMouseClicked(ImGuiMouseButton_Left))
             m_selected = false;
 
-        if (smart_bezier_collider(ImGui::GetMousePos(), start, end, 2.5)) {
+        // Geometry only changes when one of the pins moves or the zoom changes
+        bool rebuilt = m_geometry.update(start, end, m_inf->getGrid().scale());
+        ImRect hitBounds = m_geometry.bounds;
+        hitBounds.Expand(HitRadius);
+        if (rebuilt) {
+            ImRect gridBounds(m_inf->screen2grid(hitBounds.Min), m_inf->screen2grid(hitBounds.Max));
+            if (gridBounds.Min != m_indexedRect.Min || gridBounds.Max != m_indexedRect.Max) {
+                m_inf->updateLinkIndex(this, gridBounds);
+                m_indexedRect = gridBounds;
+            }
+        }
+
+        if (smart_bezier_collider(ImGui::GetMousePos(), m_geometry.curve, hitBounds, HitRadius)) {
             m_hovered = true;
             thickness = m_left->getStyle()->extra.link_hovered_thickness;
             if (mouseClickState) {
@@ -21,19 +40,64 @@ namespace ImFlow {
                 m_selected = true;
             }
         } else { m_hovered = false; }
+        if (m_hovered != wasHovered || m_selected != wasSelected)
+            m_inf->markDirty();
 
-        if (m_selected)
-            smart_bezier(start, end, m_left->getStyle()->extra.outline_color,
-                         thickness + m_left->getStyle()->extra.link_selected_outline_thickness);
-        smart_bezier(start, end, m_left->getStyle()->color, thickness);
+        if (m_selected && ImGui::IsKeyPressed(ImGuiKey_Delete, false)) {
+            m_right->deleteLink(); // Destroys this link
+            return;
+        }
 
-        if (m_selected && ImGui::IsKeyPressed(ImGuiKey_Delete, false))
-            m_right->deleteLink();
+        ImRect view(m_inf->grid2screen(m_inf->getVisibleRect().Min), m_inf->grid2screen(m_inf->getVisibleRect().Max));
+        if (!view.Overlaps(hitBounds))
+            return;
+
+        const std::vector<ImVec2> &polyline = m_geometry.polyline;
+        float outline = thickness + m_left->getStyle()->extra.link_selected_outline_thickness;
+        if (m_inf->isLinkBatching()) {
+            LinkBatch &batch = m_inf->getLinkBatch();
+            if (m_selected)
+                batch.add(polyline.data(), (int)polyline.size(), m_left->getStyle()->extra.outline_color, outline);
+            batch.add(polyline.data(), (int)polyline.size(), m_left->getStyle()->color, thickness);
+            return;
+        }
+
+        ImDrawList *draw_list = ImGui::GetWindowDrawList();
+        if (m_selected)
+            draw_list->AddPolyline(polyline.data(), (int)polyline.size(), m_left->getStyle()->extra.outline_color,
+                                   ImDrawFlags_None, outline);
+        draw_list->AddPolyline(polyline.data(), (int)polyline.size(), m_left->getStyle()->color, ImDrawFlags_None, thickness);
     }
 
     Link::~Link() {
-        if (!m_left) return;
-        m_left->deleteLink();
+        m_inf->removeLinkIndex(this);
+        m_inf->removeLink(this);
+        detach();
+    }
+
+    void Link::attach(LinkList *list) {
+        detach();
+        m_list = list;
+        m_prev = nullptr;
+        m_next = list->head;
+        if (m_next) m_next->m_prev = this;
+        list->head = this;
+        list->count++;
+    }
+
+    void Link::detach() {
+        if (!m_list) return;
+        if (m_prev) m_prev->m_next = m_next;
+        else m_list->head = m_next;
+        if (m_next) m_next->m_prev = m_prev;
+        m_list->count--;
+        m_list = nullptr;
+        m_prev = m_next = nullptr;
+    }
+
+    bool Link::isHidden() const {
+        BaseNode *group = m_left->getParent()->getHiddenBy();
+        return group && group == m_right->getParent()->getHiddenBy();
     }
 
     // -----------------------------------------------------------------------------------------------------------------
@@ -47,6 +111,7 @@ namespace ImFlow {
     }
 
     void BaseNode::update() {
+        IMNODEFLOW_PROFILE_SCOPE(m_profile.update);
         ImDrawList *draw_list = ImGui::GetWindowDrawList();
         ImGui::PushID(this);
         bool mouseClickState = m_inf->getSingleUseClick();
@@ -56,27 +121,29 @@ namespace ImFlow {
 
         draw_list->ChannelsSetCurrent(1); // Foreground
         ImGui::SetCursorScreenPos(offset + m_pos);
+        m_layoutOrigin = offset + m_pos;
 
         ImGui::BeginGroup();
 
         // Header
         ImGui::BeginGroup();
-        ImGui::TextColored(m_style->header_title_color, "%s", m_title.c_str());
+        m_titleText.item(m_title, ImGui::GetColorU32(m_style->header_title_color.Value));
         ImGui::Spacing();
         ImGui::EndGroup();
         float headerH = ImGui::GetItemRectSize().y;
+        m_headerHeight = headerH;
         float titleW = ImGui::GetItemRectSize().x;
 
         // Inputs
         if (!m_ins.empty() || !m_dynamicIns.empty()) {
             ImGui::BeginGroup();
             for (auto &p: m_ins) {
-                p->setPos(ImGui::GetCursorPos());
+                p->setPos(ImGui::GetCursorScreenPos());
                 p->update();
             }
             for (auto &p: m_dynamicIns) {
                 if (p.first == 1) {
-                    p.second->setPos(ImGui::GetCursorPos());
+                    p.second->setPos(ImGui::GetCursorScreenPos());
                     p.second->update();
                     p.first = 0;
                 }
@@ -87,7 +154,11 @@ namespace ImFlow {
 
         // Content
         ImGui::BeginGroup();
-        draw();
+        {
+            IMNODEFLOW_PROFILE_SCOPE(m_profile.draw);
+            draw();
+            m_drawnEpoch = m_inf->getHighlightEpoch();
+        }
         ImGui::Dummy(ImVec2(0.f, 0.f));
         ImGui::EndGroup();
         ImGui::SameLine();
@@ -107,24 +178,19 @@ namespace ImFlow {
         ImGui::BeginGroup();
         for (auto &p: m_outs) {
             // FIXME: This looks horrible
-            if ((m_pos + ImVec2(titleW, 0) + m_inf->getGrid().scroll()).x <
-                ImGui::GetCursorPos().x + ImGui::GetWindowPos().x + maxW)
-                p->setPos(ImGui::GetCursorPos() + ImGui::GetWindowPos() + ImVec2(maxW - p->calcWidth(), 0.f));
+            if ((offset + m_pos + ImVec2(titleW, 0)).x < ImGui::GetCursorScreenPos().x + maxW)
+                p->setPos(ImGui::GetCursorScreenPos() + ImVec2(maxW - p->calcWidth(), 0.f));
             else
-                p->setPos(ImVec2((m_pos + ImVec2(titleW - p->calcWidth(), 0) + m_inf->getGrid().scroll()).x,
-                                 ImGui::GetCursorPos().y + ImGui::GetWindowPos().y));
+                p->setPos(ImVec2((offset + m_pos + ImVec2(titleW - p->calcWidth(), 0)).x, ImGui::GetCursorScreenPos().y));
             p->update();
         }
         for (auto &p: m_dynamicOuts) {
             // FIXME: This looks horrible
-            if ((m_pos + ImVec2(titleW, 0) + m_inf->getGrid().scroll()).x <
-                ImGui::GetCursorPos().x + ImGui::GetWindowPos().x + maxW)
-                p.second->setPos(
-                        ImGui::GetCursorPos() + ImGui::GetWindowPos() + ImVec2(maxW - p.second->calcWidth(), 0.f));
+            if ((offset + m_pos + ImVec2(titleW, 0)).x < ImGui::GetCursorScreenPos().x + maxW)
+                p.second->setPos(ImGui::GetCursorScreenPos() + ImVec2(maxW - p.second->calcWidth(), 0.f));
             else
-                p.second->setPos(
-                        ImVec2((m_pos + ImVec2(titleW - p.second->calcWidth(), 0) + m_inf->getGrid().scroll()).x,
-                               ImGui::GetCursorPos().y + ImGui::GetWindowPos().y));
+                p.second->setPos(ImVec2((offset + m_pos + ImVec2(titleW - p.second->calcWidth(), 0)).x,
+                                        ImGui::GetCursorScreenPos().y));
             p.second->update();
             p.first -= 1;
         }
@@ -135,34 +201,51 @@ namespace ImFlow {
         m_size = ImGui::GetItemRectSize();
         ImVec2 headerSize = ImVec2(m_size.x + paddingBR.x, headerH);
 
-        // Background
+        // Background, replayed from cache while neither the node size nor its look changed
         draw_list->ChannelsSetCurrent(0);
-        draw_list->AddRectFilled(offset + m_pos - paddingTL, offset + m_pos + m_size + paddingBR, m_style->bg,
-                                 m_style->radius);
-        draw_list->AddRectFilled(offset + m_pos - paddingTL, offset + m_pos + headerSize, m_style->header_bg,
-                                 m_style->radius, ImDrawFlags_RoundCornersTop);
+        ImU32 headerBg = m_style->header_bg;
+#if IMNODEFLOW_PROFILING
+        if (m_inf->isProfileHeatmap() && m_inf->getProfileMaxNodeTime() > 0.0) {
+            float heat = ImSaturate((float)(m_profile.update.last / m_inf->getProfileMaxNodeTime()));
+            headerBg = ImGui::ColorConvertFloat4ToU32(ImLerp(ImGui::ColorConvertU32ToFloat4(headerBg),
+                                                             ImVec4(0.9f, 0.15f, 0.1f, 1.f), heat));
+        }
+#endif
         m_fullSize = m_size + paddingTL + paddingBR;
         ImU32 col = m_style->border_color;
         float thickness = m_style->border_thickness;
-        ImVec2 ptl = paddingTL;
-        ImVec2 pbr = paddingBR;
         if (m_selected) {
             col = m_style->border_selected_color;
             thickness = m_style->border_selected_thickness;
         }
-        if (thickness < 0.f) {
-            ptl.x -= thickness / 2;
-            ptl.y -= thickness / 2;
-            pbr.x -= thickness / 2;
-            pbr.y -= thickness / 2;
-            thickness *= -1.f;
+        ImVec2 origin = offset + m_pos;
+        BackgroundKey bgKey = {m_size, paddingTL, paddingBR, draw_list->_Data->TexUvWhitePixel, headerH,
+                               m_style->radius, thickness, draw_list->_FringeScale, m_style->bg, headerBg, col,
+                               (int)draw_list->Flags};
+        if (m_inf->isDrawCaching() && m_bgCache.valid() && memcmp(&bgKey, &m_bgKey, sizeof(BackgroundKey)) == 0)
+            m_bgCache.replay(draw_list, origin);
+        else {
+            m_bgKey = bgKey;
+            m_bgCache.beginRecord(draw_list);
+            draw_list->AddRectFilled(origin - paddingTL, origin + m_size + paddingBR, m_style->bg, m_style->radius);
+            draw_list->AddRectFilled(origin - paddingTL, origin + headerSize, headerBg, m_style->radius,
+                                     ImDrawFlags_RoundCornersTop);
+            ImVec2 ptl = paddingTL;
+            ImVec2 pbr = paddingBR;
+            if (thickness < 0.f) {
+                ptl.x -= thickness / 2;
+                ptl.y -= thickness / 2;
+                pbr.x -= thickness / 2;
+                pbr.y -= thickness / 2;
+                thickness *= -1.f;
+            }
+            draw_list->AddRect(origin - ptl, origin + m_size + pbr, col, m_style->radius, 0, thickness);
+            if (m_inf->isDrawCaching())
+                m_bgCache.endRecord(draw_list, origin);
+            else
+                m_bgCache.clear();
         }
-        draw_list->AddRect(offset + m_pos - ptl, offset + m_pos + m_size + pbr, col, m_style->radius, 0, thickness);
-
 
-        if (ImGui::IsWindowHovered() && !ImGui::IsKeyDown(ImGuiKey_LeftCtrl) &&
-            ImGui::IsMouseClicked(ImGuiMouseButton_Left) && !m_inf->on_selected_node())
-            selected(false);
 
         if (isHovered()) {
             m_inf->hoveredNode(this);
@@ -172,37 +255,364 @@ namespace ImFlow {
             }
         }
 
-        if (ImGui::IsWindowFocused() && ImGui::IsKeyPressed(ImGuiKey_Delete) && !ImGui::IsAnyItemActive() && isSelected())
-            destroy();
-
         bool onHeader = ImGui::IsMouseHoveringRect(offset + m_pos - paddingTL, offset + m_pos + headerSize);
         if (onHeader && mouseClickState) {
             m_inf->consumeSingleUseClick();
             m_dragged = true;
             m_inf->draggingNode(true);
         }
-        if (m_dragged || (m_selected && m_inf->isNodeDragged())) {
-            float step = m_inf->getStyle().grid_size / m_inf->getStyle().grid_subdivisions;
-            m_posTarget += m_inf->getScreenSpaceDelta();
-            // "Slam" The position
-            m_pos.x = round(m_posTarget.x / step) * step;
-            m_pos.y = round(m_posTarget.y / step) * step;
-
-            if (ImGui::IsMouseReleased(ImGuiMouseButton_Left)) {
-                m_dragged = false;
-                m_inf->draggingNode(false);
-                m_posTarget = m_pos;
-            }
-        }
+        updateIndex();
         ImGui::PopID();
 
         // Deleting dead pins
+        size_t dynamicIns = m_dynamicIns.size(), dynamicOuts = m_dynamicOuts.size();
         m_dynamicIns.erase(std::remove_if(m_dynamicIns.begin(), m_dynamicIns.end(),
                                           [](const std::pair<int, std::shared_ptr<Pin>> &p) { return p.first == 0; }),
                            m_dynamicIns.end());
         m_dynamicOuts.erase(std::remove_if(m_dynamicOuts.begin(), m_dynamicOuts.end(),
                                            [](const std::pair<int, std::shared_ptr<Pin>> &p) { return p.first == 0; }),
                             m_dynamicOuts.end());
+        if (m_dynamicIns.size() != dynamicIns)
+            indexDynamic(m_dynamicIns, m_dynamicInsIndex);
+        if (m_dynamicOuts.size() != dynamicOuts)
+            indexDynamic(m_dynamicOuts, m_dynamicOutsIndex);
+    }
+
+    void BaseNode::dropPin(std::vector<std::shared_ptr<Pin>> &pins, PinIndex<Pin*> &index, PinUID h) {
+        auto it = std::find_if(pins.begin(), pins.end(), [h](const std::shared_ptr<Pin> &p) { return p->getUid() == h; });
+        if (it == pins.end())
+            return;
+        pins.erase(it);
+        index.erase(h);
+        // Pins sharing the UID become reachable again
+        it = std::find_if(pins.begin(), pins.end(), [h](const std::shared_ptr<Pin> &p) { return p->getUid() == h; });
+        if (it != pins.end())
+            index.insert(h, it->get());
+    }
+
+    void BaseNode::indexDynamic(const std::vector<std::pair<int, std::shared_ptr<Pin>>> &pins, PinIndex<size_t> &index) {
+        index.clear();
+        for (size_t i = 0; i < pins.size(); i++)
+            index.insert(pins[i].second->getUid(), i);
+    }
+
+    void BaseNode::resetProfile() {
+        m_profile.update.reset();
+        m_profile.draw.reset();
+        for (auto &p: m_ins) p->resetProfile();
+        for (auto &p: m_outs) p->resetProfile();
+        for (auto &p: m_dynamicIns) p.second->resetProfile();
+        for (auto &p: m_dynamicOuts) p.second->resetProfile();
+    }
+
+    void BaseNode::updateCulled() {
+        followPins();
+        m_bgCache.clear();
+
+        updateIndex();
+    }
+
+    void BaseNode::updateLOD(int lod) {
+        followPins();
+        m_bgCache.clear();
+        ImDrawList *draw_list = ImGui::GetWindowDrawList();
+        bool mouseClickState = m_inf->getSingleUseClick();
+        ImVec2 origin = m_inf->grid2screen(m_pos);
+        ImVec2 min = origin - ImVec2(m_style->padding.x, m_style->padding.y);
+        ImVec2 max = min + m_fullSize;
+
+        draw_list->ChannelsSetCurrent(0);
+        bool overPin = false;
+        if (lod == NodeLOD_Quad) {
+            draw_list->AddRectFilled(min, max, m_style->header_bg);
+        } else {
+            draw_list->AddRectFilled(min, max, m_style->bg, m_style->radius);
+            draw_list->AddRectFilled(min, ImVec2(max.x, origin.y + m_headerHeight), m_style->header_bg, m_style->radius,
+                                     ImDrawFlags_RoundCornersTop);
+            draw_list->ChannelsSetCurrent(1);
+            for (auto &p: m_ins) overPin |= p->drawDot();
+            for (auto &p: m_outs) overPin |= p->drawDot();
+            draw_list->ChannelsSetCurrent(0);
+        }
+        if (m_selected)
+            draw_list->AddRect(min, max, m_style->border_selected_color, m_style->radius, 0,
+                               m_style->border_selected_thickness);
+
+        // Headers are too small to aim at, the whole node drags
+        if (ImGui::IsMouseHoveringRect(min, max)) {
+            m_inf->hoveredNode(this);
+            if (mouseClickState && !overPin) {
+                selected(true);
+                m_inf->consumeSingleUseClick();
+                m_dragged = true;
+                m_inf->draggingNode(true);
+            }
+        }
+
+        updateIndex();
+    }
+
+    bool BaseNode::isCullable(const ImRect& view) const {
+        if (m_dragged || m_fullSize.x <= 0.f || m_fullSize.y <= 0.f)
+            return false;
+        ImVec2 paddingTL = {m_style->padding.x, m_style->padding.y};
+        return !view.Overlaps(ImRect(m_pos - paddingTL, m_pos - paddingTL + m_fullSize));
+    }
+
+    void BaseNode::invalidate() {
+        if (m_destroyed)
+            return;
+        if (m_inf)
+            m_inf->markDirty();
+        for (auto &p: m_outs)
+            p->invalidate();
+        for (auto &p: m_dynamicOuts)
+            p.second->invalidate();
+    }
+
+    BaseNode *BaseNode::setHandler(ImNodeFlow *inf) {
+        m_inf = inf;
+        updateIndex();
+        if (m_inf && m_selectedNext != m_selected)
+            m_inf->selectionChanged(this);
+        return this;
+    }
+
+    BaseNode *BaseNode::selected(bool state) {
+        // Anything already pending was queued when it was set
+        if (m_inf && state != m_selectedNext)
+            m_inf->selectionChanged(this);
+        m_selectedNext = state;
+        return this;
+    }
+
+    void BaseNode::dragBy(const ImVec2 &delta, bool release) {
+        float step = m_inf->getStyle().grid_size / m_inf->getStyle().grid_subdivisions;
+        m_posTarget += delta;
+        // "Slam" The position
+        ImVec2 pos = m_pos;
+        m_pos.x = round(m_posTarget.x / step) * step;
+        m_pos.y = round(m_posTarget.y / step) * step;
+        if (m_pos.x != pos.x || m_pos.y != pos.y)
+            m_inf->markDirty();
+
+        if (release) {
+            m_dragged = false;
+            m_posTarget = m_pos;
+        }
+    }
+
+    void BaseNode::attachPin(Pin *pin) {
+        // Aliasing an empty owner: a shared_ptr like the other pins, without an allocation or a reference count
+        std::shared_ptr<Pin> p(std::shared_ptr<Pin>(), pin);
+        if (pin->getType() == PinType_Input) {
+            m_ins.emplace_back(std::move(p));
+            m_insIndex.insert(pin->getUid(), pin);
+        } else {
+            m_outs.emplace_back(std::move(p));
+            m_outsIndex.insert(pin->getUid(), pin);
+        }
+    }
+
+    void BaseNode::setHiddenBy(BaseNode *group) {
+        if (group == m_hiddenBy)
+            return;
+        m_hiddenBy = group;
+        if (group) {
+            selected(false);
+            m_dragged = false;
+            m_bgCache.clear();
+        } else
+            m_fullSize = ImVec2(0.f, 0.f); // The pins were moved by the group, lay the node out again
+        updateIndex();
+        if (m_inf)
+            m_inf->markDirty();
+    }
+
+    void BaseNode::updateIndex() {
+        if (!m_inf || !m_style)
+            return;
+        ImVec2 paddingTL = {m_style->padding.x, m_style->padding.y};
+        ImRect rect(m_pos - paddingTL, m_pos - paddingTL + m_fullSize);
+        uint8_t flags = NodeStateFlags_None;
+        if (m_fullSize.x > 0.f && m_fullSize.y > 0.f) flags |= NodeStateFlags_Laid;
+        if (m_dragged) flags |= NodeStateFlags_Dragged;
+        if (m_selected) flags |= NodeStateFlags_Selected;
+        if (m_hiddenBy) {
+            m_inf->updateNodeState(m_uid, rect, flags | NodeStateFlags_Hidden);
+            m_inf->removeNodeIndex(this);
+            m_indexedRect = ImRect(0.f, 0.f, -1.f, -1.f);
+            return;
+        }
+        m_inf->updateNodeState(m_uid, rect, flags);
+        if (rect.Min == m_indexedRect.Min && rect.Max == m_indexedRect.Max)
+            return;
+        m_inf->updateNodeIndex(this, rect);
+        m_indexedRect = rect;
+    }
+
+    void BaseNode::followPins() {
+        ImVec2 origin = m_inf->grid2screen(m_pos);
+        ImVec2 delta = origin - m_layoutOrigin;
+        if (delta.x == 0.f && delta.y == 0.f)
+            return;
+        for (auto &p: m_ins) p->setPos(p->getPos() + delta);
+        for (auto &p: m_dynamicIns) p.second->setPos(p.second->getPos() + delta);
+        for (auto &p: m_outs) p->setPos(p->getPos() + delta);
+        for (auto &p: m_dynamicOuts) p.second->setPos(p.second->getPos() + delta);
+        m_layoutOrigin = origin;
+    }
+
+    // -----------------------------------------------------------------------------------------------------------------
+    // GROUP NODE
+
+    GroupNode *GroupNode::addMember(BaseNode *node) {
+        IM_ASSERT(node != this && node->getHandler() == getHandler() && !node->isHidden());
+        m_members.push_back(node->getUID());
+        BaseNode *hider = getHiddenBy() ? getHiddenBy() : m_collapsed ? this : nullptr;
+        if (!hider)
+            return this;
+        node->setHiddenBy(hider);
+        if (auto *g = dynamic_cast<GroupNode *>(node))
+            g->hideMembers(hider);
+        m_pinsOrigin = ImVec2(FLT_MAX, FLT_MAX);
+        return this;
+    }
+
+    GroupNode *GroupNode::removeMember(BaseNode *node) {
+        NodeUID uid = node->getUID();
+        m_members.erase(std::remove(m_members.begin(), m_members.end(), uid), m_members.end());
+        auto exposedBy = [uid](const std::pair<NodeUID, PinUID> &e) { return e.first == uid; };
+        m_exposedIns.erase(std::remove_if(m_exposedIns.begin(), m_exposedIns.end(), exposedBy), m_exposedIns.end());
+        m_exposedOuts.erase(std::remove_if(m_exposedOuts.begin(), m_exposedOuts.end(), exposedBy), m_exposedOuts.end());
+        node->setHiddenBy(nullptr);
+        if (auto *g = dynamic_cast<GroupNode *>(node))
+            g->hideMembers(nullptr);
+        return this;
+    }
+
+    GroupNode *GroupNode::collapse(bool state) {
+        if (state == m_collapsed)
+            return this;
+        m_collapsed = state;
+        hideMembers(getHiddenBy());
+        m_pinsOrigin = ImVec2(FLT_MAX, FLT_MAX);
+        return this;
+    }
+
+    void GroupNode::draw() {
+        if (ImGui::SmallButton(m_collapsed ? "Expand" : "Collapse"))
+            collapse(!m_collapsed);
+
+        if (!m_collapsed) {
+            // Frame around the members, they are drawn by the handler
+            ImRect bounds(FLT_MAX, FLT_MAX, -FLT_MAX, -FLT_MAX);
+            forEachMember([&bounds](BaseNode *n) { bounds.Add(ImRect(n->getPos(), n->getPos() + n->getFullSize())); },
+                          false);
+            if (bounds.Min.x <= bounds.Max.x) {
+                ImVec2 pad(getStyle()->padding.x, getStyle()->padding.y);
+                ImGui::GetWindowDrawList()->AddRect(getHandler()->grid2screen(bounds.Min - pad * 2.f),
+                                                    getHandler()->grid2screen(bounds.Max),
+                                                    getStyle()->border_color, getStyle()->radius);
+            }
+            return;
+        }
+
+        ImGui::Text("%d nodes", (int)m_members.size());
+        ImVec2 origin = getHandler()->grid2screen(getPos());
+        if (origin.x != m_pinsOrigin.x || origin.y != m_pinsOrigin.y)
+            placeHiddenPins();
+        ImGui::BeginGroup();
+        layoutExposed(m_exposedIns, true);
+        ImGui::EndGroup();
+        ImGui::SameLine();
+        ImGui::BeginGroup();
+        layoutExposed(m_exposedOuts, false);
+        ImGui::EndGroup();
+    }
+
+    void GroupNode::destroy() {
+        BaseNode::destroy();
+        forEachMember([](BaseNode *n) { n->destroy(); }, false);
+    }
+
+    void GroupNode::dragBy(const ImVec2 &delta, bool release) {
+        ImVec2 pos = getPos();
+        BaseNode::dragBy(delta, release);
+        ImVec2 moved = getPos() - pos;
+        if (moved.x == 0.f && moved.y == 0.f)
+            return;
+        // Selected members are dragged on their own
+        forEachMember([moved](BaseNode *n) { if (!n->isSelected()) n->setPos(n->getPos() + moved); }, true);
+    }
+
+    void GroupNode::followPins() {
+        BaseNode::followPins();
+        if (!m_collapsed)
+            return;
+        ImVec2 origin = getHandler()->grid2screen(getPos());
+        if (origin.x != m_pinsOrigin.x || origin.y != m_pinsOrigin.y)
+            placeHiddenPins();
+    }
+
+    void GroupNode::hideMembers(BaseNode *by) {
+        BaseNode *hider = by ? by : m_collapsed ? this : nullptr;
+        forEachMember([hider](BaseNode *n) {
+            n->setHiddenBy(hider);
+            if (auto *g = dynamic_cast<GroupNode *>(n))
+                g->hideMembers(hider);
+        }, false);
+    }
+
+    void GroupNode::placeHiddenPins() {
+        // Links leaving the group start from its title line
+        ImVec2 origin = getHandler()->grid2screen(getPos());
+        float right = origin.x + getSize().x;
+        m_pinsOrigin = origin;
+        forEachMember([origin, right](BaseNode *n) {
+            for (auto &p: n->getIns())
+                p->setPos(origin);
+            for (auto &p: n->getOuts())
+                p->setPos(ImVec2(right - p->getSize().x, origin.y));
+        }, true);
+    }
+
+    void GroupNode::layoutExposed(std::vector<std::pair<NodeUID, PinUID>> &pins, bool inputs) {
+        NodeStorage &nodes = getHandler()->getNodes();
+        for (size_t i = 0; i < pins.size();) {
+            size_t k = nodes.indexOf(pins[i].first);
+            Pin *p = nullptr;
+            if (k != nodes.size())
+                p = inputs ? nodes[k].second->findIn(pins[i].second) : nodes[k].second->findOut(pins[i].second);
+            if (!p) {
+                pins.erase(pins.begin() + (std::ptrdiff_t)i);
+                continue;
+            }
+            p->setPos(ImGui::GetCursorScreenPos());
+            p->update();
+            i++;
+        }
+    }
+
+    void GroupNode::forEachMember(const std::function<void(BaseNode *)> &f, bool recursive) {
+        ImNodeFlow *inf = getHandler();
+        if (!inf)
+            return;
+        // Members erased from the handler are dropped along the way
+        NodeStorage &nodes = inf->getNodes();
+        size_t kept = 0;
+        for (size_t i = 0; i < m_members.size(); i++) {
+            size_t k = nodes.indexOf(m_members[i]);
+            if (k == nodes.size())
+                continue;
+            m_members[kept++] = m_members[i];
+            BaseNode *n = nodes[k].second.get();
+            f(n);
+            if (recursive)
+                if (auto *g = dynamic_cast<GroupNode *>(n))
+                    g->forEachMember(f, true);
+        }
+        m_members.resize(kept);
     }
 
     // -----------------------------------------------------------------------------------------------------------------
@@ -211,86 +621,378 @@ namespace ImFlow {
     int ImNodeFlow::m_instances = 0;
 
     bool ImNodeFlow::on_selected_node() {
-        return std::any_of(m_nodes.begin(), m_nodes.end(),
-                           [](const auto &n) { return n.second->isSelected() && n.second->isHovered(); });
+        m_nodesIndex.query(screen2grid(ImGui::GetMousePos()), m_queryNodes);
+        return std::any_of(m_queryNodes.begin(), m_queryNodes.end(),
+                           [](BaseNode* n) { return n->isSelected() && n->isHovered(); });
     }
 
     bool ImNodeFlow::on_free_space() {
-        return std::all_of(m_nodes.begin(), m_nodes.end(),
-                           [](const auto &n) { return !n.second->isHovered(); })
-               && std::all_of(m_links.begin(), m_links.end(),
-                              [](const auto &l) { return !l.lock()->isHovered(); });
+        ImVec2 mouse = screen2grid(ImGui::GetMousePos());
+        m_nodesIndex.query(mouse, m_queryNodes);
+        m_linksIndex.query(mouse, m_queryLinks);
+        return std::all_of(m_queryNodes.begin(), m_queryNodes.end(),
+                           [](BaseNode* n) { return !n->isHovered(); })
+               && std::all_of(m_queryLinks.begin(), m_queryLinks.end(),
+                              [](Link* l) { return !l->isHovered(); });
     }
 
     ImVec2 ImNodeFlow::screen2grid( const ImVec2 & p )
     {
-        if ( ImGui::GetCurrentContext() == m_context.getRawContext() )
-            return p - m_context.scroll();
+        if ( m_context.inCanvas() )
+            return p - m_context.canvasOrigin() - m_context.scroll();
         return ( p - m_context.origin() ) / m_context.scale() - m_context.scroll();
     }
 
     ImVec2 ImNodeFlow::grid2screen( const ImVec2 & p )
     {
-        if ( ImGui::GetCurrentContext() == m_context.getRawContext() )
-            return p + m_context.scroll();
+        if ( m_context.inCanvas() )
+            return p + m_context.scroll() + m_context.canvasOrigin();
         return ( p + m_context.scroll() ) * m_context.scale() + m_context.origin();
     }
 
+    void ImNodeFlow::evaluate() {
+        m_evalEpoch++;
+
+        // Kahn's algorithm, one dependency level at a time, over the dense node indices
+        const uint32_t count = (uint32_t)m_nodes.size();
+        m_evalInDegree.assign(count, 0);
+        m_evalStart.assign(count + 1, 0);
+        m_evalLinkFrom.clear();
+        m_evalLinkTo.clear();
+        for (Link *link: m_links) {
+            if (!link) continue;
+            uint32_t from = (uint32_t)m_nodes.indexOf(link->left()->getParent()->getUID());
+            uint32_t to = (uint32_t)m_nodes.indexOf(link->right()->getParent()->getUID());
+            if (from == count || to == count) continue;
+            m_evalLinkFrom.push_back(from);
+            m_evalLinkTo.push_back(to);
+            m_evalInDegree[to]++;
+            m_evalStart[from + 1]++;
+        }
+        for (uint32_t i = 0; i < count; i++)
+            m_evalStart[i + 1] += m_evalStart[i];
+        m_evalDownstream.resize(m_evalLinkFrom.size());
+        m_evalNext.assign(m_evalStart.begin(), m_evalStart.end() - 1); // Fill positions
+        for (size_t k = 0; k < m_evalLinkFrom.size(); k++)
+            m_evalDownstream[m_evalNext[m_evalLinkFrom[k]]++] = m_evalLinkTo[k];
+
+        m_evalLevel.clear();
+        for (uint32_t i = 0; i < count; i++)
+            if (m_evalInDegree[i] == 0)
+                m_evalLevel.push_back(i);
+
+        const std::function<void(size_t)> resolvePin = [this](size_t i) { m_evalPins[i]->resolve(); };
+        while (!m_evalLevel.empty()) {
+            m_evalPins.clear();
+            for (uint32_t i: m_evalLevel) {
+                BaseNode *n = m_nodes[i].second.get();
+                for (auto &p: n->getOuts())
+                    m_evalPins.push_back(p.get());
+                for (auto &p: n->getDynamicOuts())
+                    m_evalPins.push_back(p.second.get());
+            }
+            m_evalPool.parallelFor(m_evalPins.size(), resolvePin);
+
+            m_evalNext.clear();
+            for (uint32_t i: m_evalLevel)
+                for (uint32_t k = m_evalStart[i]; k < m_evalStart[i + 1]; k++)
+                    if (--m_evalInDegree[m_evalDownstream[k]] == 0)
+                        m_evalNext.push_back(m_evalDownstream[k]);
+            std::swap(m_evalLevel, m_evalNext);
+        }
+
+        // Whatever is left is in, or downstream of, a cycle
+        for (uint32_t i = 0; i < count; i++)
+            if (m_evalInDegree[i] > 0) {
+                BaseNode *n = m_nodes[i].second.get();
+                for (auto &p: n->getOuts())
+                    p->resolve();
+                for (auto &p: n->getDynamicOuts())
+                    p.second->resolve();
+            }
+    }
+
+    void ImNodeFlow::updateNodeState(NodeUID uid, const ImRect &rect, uint8_t flags) {
+        size_t i = m_nodes.indexOf(uid);
+        if (i == m_nodes.size())
+            return;
+        m_nodes.column<NodeColumn_Rect>()[i] = rect;
+        m_nodes.column<NodeColumn_Flags>()[i] = flags;
+    }
+
+    void ImNodeFlow::setLazyEvaluation(bool state) {
+        // Values were not tracked while disabled
+        if (state && !m_lazy)
+            for (auto &node: m_nodes)
+                node.second->invalidate();
+        m_lazy = state;
+    }
+
     void ImNodeFlow::addLink(std::shared_ptr<Link> &link) {
-        m_links.push_back(link);
+        m_dirty = true;
+        link->setTableIndex(m_links.size());
+        m_links.push_back(link.get());
+    }
+
+    void ImNodeFlow::removeLink(Link *link) {
+        size_t i = link->getTableIndex();
+        if (i >= m_links.size() || m_links[i] != link)
+            return;
+        m_links[i] = nullptr;
+        m_linksHoles = true;
+        m_dirty = true;
+    }
+
+    void ImNodeFlow::selectionChanged(BaseNode *node) {
+        m_selectionChanges.push_back(node->getUID());
+    }
+
+    void ImNodeFlow::clearSelection() {
+        for (NodeUID uid: m_selection)
+            m_nodes.at(uid)->selected(false);
+    }
+
+    void ImNodeFlow::selectRect(const ImRect &rect) {
+        m_nodesIndex.query(rect, m_queryNodes);
+        for (BaseNode *n: m_queryNodes)
+            n->selected(true);
+    }
+
+    void ImNodeFlow::compatiblePins(Pin *dragged, const ImRect &area, std::vector<Pin*> &out) {
+        out.clear();
+        m_nodesIndex.query(area, m_queryNodes);
+        const bool fromOutput = dragged->getType() == PinType_Output;
+        for (BaseNode *n: m_queryNodes) {
+            for (auto &p: fromOutput ? n->getIns() : n->getOuts())
+                if (dragged->canConnect(p.get()))
+                    out.push_back(p.get());
+            for (auto &p: fromOutput ? n->getDynamicIns() : n->getDynamicOuts())
+                if (dragged->canConnect(p.second.get()))
+                    out.push_back(p.second.get());
+        }
+    }
+
+    void ImNodeFlow::applySelection() {
+        for (NodeUID uid: m_selectionChanges) {
+            size_t i = m_nodes.indexOf(uid);
+            if (i == m_nodes.size())
+                continue;
+            BaseNode *node = m_nodes[i].second.get();
+            bool wasSelected = node->isSelected();
+            node->updatePublicStatus();
+            if (node->isSelected() == wasSelected)
+                continue;
+            if (wasSelected)
+                dropSelection(node);
+            else {
+                node->setSelectionIndex(m_selection.size());
+                m_selection.push_back(uid);
+            }
+            m_dirty = true;
+        }
+        m_selectionChanges.clear();
+
+        // Nodes are erased right after, only the selected ones can be referenced here
+        for (size_t i = 0; i < m_selection.size();) {
+            BaseNode *node = m_nodes.at(m_selection[i]).get();
+            if (node->toDestroy())
+                dropSelection(node);
+            else
+                i++;
+        }
+    }
+
+    void ImNodeFlow::dropSelection(BaseNode *node) {
+        size_t i = node->getSelectionIndex();
+        if (i >= m_selection.size() || m_selection[i] != node->getUID())
+            return;
+        m_selection[i] = m_selection.back();
+        m_selection.pop_back();
+        if (i < m_selection.size())
+            m_nodes.at(m_selection[i])->setSelectionIndex(i);
+    }
+
+    void ImNodeFlow::updateSelectionDrag() {
+        if (!m_draggingNode)
+            return;
+        ImVec2 delta = getScreenSpaceDelta();
+        bool release = !ImGui::IsMouseDown(ImGuiMouseButton_Left);
+        for (NodeUID uid: m_selection)
+            m_nodes.at(uid)->dragBy(delta, release);
+        if (release)
+            draggingNode(false);
+    }
+
+    void ImNodeFlow::updateBoxSelection(ImDrawList *draw_list) {
+        // Started by a click that no node, link or pin took
+        if (!m_boxSelecting && m_singleUseClick && !m_hovering && !m_dragOut && ImGui::IsWindowHovered()) {
+            m_boxSelecting = true;
+            m_boxStart = screen2grid(ImGui::GetMousePos());
+        }
+        if (!m_boxSelecting)
+            return;
+
+        ImVec2 a = grid2screen(m_boxStart), b = ImGui::GetMousePos();
+        ImRect box(ImMin(a, b), ImMax(a, b));
+        draw_list->AddRectFilled(box.Min, box.Max, m_style.colors.box_selection);
+        draw_list->AddRect(box.Min, box.Max, m_style.colors.box_selection_border);
+        if (!ImGui::IsMouseDown(ImGuiMouseButton_Left)) {
+            m_boxSelecting = false;
+            selectRect(ImRect(screen2grid(box.Min), screen2grid(box.Max)));
+        }
+        m_dirty = true;
+    }
+
+    void ImNodeFlow::compactLinks() {
+        if (!m_linksHoles)
+            return;
+        m_links.erase(std::remove(m_links.begin(), m_links.end(), nullptr), m_links.end());
+        for (size_t i = 0; i < m_links.size(); i++)
+            m_links[i]->setTableIndex(i);
+        m_linksHoles = false;
     }
 
     void ImNodeFlow::update() {
+        for (ProfileStat &p: m_profile)
+            p.reset();
+        m_profileMaxNode = m_profileFrameMax;
+        m_profileFrameMax = 0.0;
+        IMNODEFLOW_PROFILE_LAP_BEGIN(frame);
+        IMNODEFLOW_PROFILE_LAP_BEGIN(lap);
+
         // Updating looping stuff
+        m_dirty = false;
+        Pin *hoveringPrev = m_hovering;
+        BaseNode *hoveredNodePrev = m_hoveredNode;
         m_hovering = nullptr;
         m_hoveredNode = nullptr;
         m_draggingNode = m_draggingNodeNext;
         m_singleUseClick = ImGui::IsMouseClicked(ImGuiMouseButton_Left);
+        pollAsync();
+        IMNODEFLOW_PROFILE_LAP(lap, m_profile[ProfilePhase_Async]);
 
         // Create child canvas
         m_context.begin();
-        ImGui::GetIO().IniFilename = nullptr;
+        IMNODEFLOW_PROFILE_LAP(lap, m_profile[ProfilePhase_Begin]);
 
         ImDrawList *draw_list = ImGui::GetWindowDrawList();
 
         // Display grid
-        ImVec2 gridSize = ImGui::GetWindowSize();
-        float subGridStep = m_style.grid_size / m_style.grid_subdivisions;
-        for (float x = fmodf(m_context.scroll().x, m_style.grid_size); x < gridSize.x; x += m_style.grid_size)
-            draw_list->AddLine(ImVec2(x, 0.0f), ImVec2(x, gridSize.y), m_style.colors.grid);
-        for (float y = fmodf(m_context.scroll().y, m_style.grid_size); y < gridSize.y; y += m_style.grid_size)
-            draw_list->AddLine(ImVec2(0.0f, y), ImVec2(gridSize.x, y), m_style.colors.grid);
-        if (m_context.scale() > 0.7f) {
-            for (float x = fmodf(m_context.scroll().x, subGridStep); x < gridSize.x; x += subGridStep)
-                draw_list->AddLine(ImVec2(x, 0.0f), ImVec2(x, gridSize.y), m_style.colors.subGrid);
-            for (float y = fmodf(m_context.scroll().y, subGridStep); y < gridSize.y; y += subGridStep)
-                draw_list->AddLine(ImVec2(0.0f, y), ImVec2(gridSize.x, y), m_style.colors.subGrid);
+        ImVec2 canvasMin = m_context.canvasOrigin();
+        ImVec2 gridSize = m_context.size() / m_context.scale();
+        m_visibleRect = ImRect(screen2grid(canvasMin), screen2grid(canvasMin + gridSize));
+        GridKey gridKey = {gridSize, m_context.scroll(), draw_list->_Data->TexUvWhitePixel, m_style.grid_size,
+                           m_style.grid_subdivisions, draw_list->_FringeScale, m_style.colors.grid,
+                           m_style.colors.subGrid, m_context.scale() > 0.7f, (int)draw_list->Flags};
+        if (m_drawCaching && m_gridCache.valid() && memcmp(&gridKey, &m_gridKey, sizeof(GridKey)) == 0)
+            m_gridCache.replay(draw_list, canvasMin);
+        else {
+            m_gridKey = gridKey;
+            m_gridCache.beginRecord(draw_list);
+            float subGridStep = m_style.grid_size / m_style.grid_subdivisions;
+            for (float x = fmodf(m_context.scroll().x, m_style.grid_size); x < gridSize.x; x += m_style.grid_size)
+                draw_list->AddLine(canvasMin + ImVec2(x, 0.0f), canvasMin + ImVec2(x, gridSize.y), m_style.colors.grid);
+            for (float y = fmodf(m_context.scroll().y, m_style.grid_size); y < gridSize.y; y += m_style.grid_size)
+                draw_list->AddLine(canvasMin + ImVec2(0.0f, y), canvasMin + ImVec2(gridSize.x, y), m_style.colors.grid);
+            if (gridKey.subGridVisible) {
+                for (float x = fmodf(m_context.scroll().x, subGridStep); x < gridSize.x; x += subGridStep)
+                    draw_list->AddLine(canvasMin + ImVec2(x, 0.0f), canvasMin + ImVec2(x, gridSize.y), m_style.colors.subGrid);
+                for (float y = fmodf(m_context.scroll().y, subGridStep); y < gridSize.y; y += subGridStep)
+                    draw_list->AddLine(canvasMin + ImVec2(0.0f, y), canvasMin + ImVec2(gridSize.x, y), m_style.colors.subGrid);
+            }
+            if (m_drawCaching)
+                m_gridCache.endRecord(draw_list, canvasMin);
+            else
+                m_gridCache.clear();
         }
 
+        IMNODEFLOW_PROFILE_LAP(lap, m_profile[ProfilePhase_Grid]);
+
+        float scale = m_context.scale();
+        m_lod = scale < m_style.lod_quad_zoom ? NodeLOD_Quad : scale < m_style.lod_simple_zoom ? NodeLOD_Simple : NodeLOD_Full;
+
+        // Stream in pending nodes, drawn below the others
+        updateStream(draw_list);
+        IMNODEFLOW_PROFILE_LAP(lap, m_profile[ProfilePhase_Stream]);
+
         // Update and draw nodes
         // TODO: I don't like this
+        m_nodesIndex.setCellSize(m_style.grid_size);
+        m_linksIndex.setCellSize(m_style.grid_size);
+
+        // Selection: a click outside of it clears it, Delete destroys it and dragging moves it as a whole
+        if (ImGui::IsWindowHovered() && !ImGui::IsKeyDown(ImGuiKey_LeftCtrl) &&
+            ImGui::IsMouseClicked(ImGuiMouseButton_Left) && !on_selected_node())
+            clearSelection();
+        if (ImGui::IsWindowFocused() && ImGui::IsKeyPressed(ImGuiKey_Delete) && !ImGui::IsAnyItemActive())
+            for (NodeUID uid: m_selection)
+                m_nodes.at(uid)->destroy();
+        updateSelectionDrag();
+
+        // Sockets accepting the link being dragged, drawn with a ring by the nodes below
+        if (++m_highlightEpoch == 0)
+            m_highlightEpoch = 1;
+        if (m_dragOut) {
+            compatiblePins(m_dragOut, m_visibleRect, m_compatiblePins);
+            for (Pin *p: m_compatiblePins)
+                p->highlight(m_highlightEpoch);
+        }
+
         draw_list->ChannelsSplit(2);
-        for (auto &node: m_nodes) { node.second->update(); }
-        // Remove "toDelete" nodes
-        for (auto iter = m_nodes.begin(); iter != m_nodes.end();) {
-            if (iter->second->toDestroy())
-                iter = m_nodes.erase(iter);
+        // Indexed loop: nodes added while updating are stored at the end and start next frame
+        for (size_t i = 0, count = m_nodes.size(); i < count; i++) {
+            uint8_t flags = m_nodes.column<NodeColumn_Flags>()[i];
+            if (flags & NodeStateFlags_Hidden)
+                continue;
+            bool culled = m_culling && (flags & NodeStateFlags_Laid) && !(flags & NodeStateFlags_Dragged) &&
+                          !m_visibleRect.Overlaps(m_nodes.column<NodeColumn_Rect>()[i]);
+            if (culled)
+                m_nodes[i].second->updateCulled();
+            else if (m_lod != NodeLOD_Full && (flags & NodeStateFlags_Laid))
+                m_nodes[i].second->updateLOD(m_lod);
             else
-                ++iter;
+                m_nodes[i].second->update();
+#if IMNODEFLOW_PROFILING
+            m_profileFrameMax = std::max(m_profileFrameMax, m_nodes[i].second->getProfile().update.last);
+#endif
         }
         draw_list->ChannelsMerge();
-        for (auto &node: m_nodes) { node.second->updatePublicStatus(); }
+        applySelection();
+        eraseDestroyed();
+        // Loaded links to dynamic pins, connected once draw() has shown them. Dropped if draw() ran on both nodes
+        // without showing the pins: the pin may be behind a condition that stays false, or renamed
+        if (!m_deferredLinks.empty())
+            m_deferredLinks.erase(std::remove_if(m_deferredLinks.begin(), m_deferredLinks.end(),
+                                                 [this](const DeferredLink &l) {
+                                                     if (connectDeferred(l))
+                                                         return true;
+                                                     if (!m_nodes.at(l.from)->drawnThisFrame() || !m_nodes.at(l.to)->drawnThisFrame())
+                                                         return false;
+                                                     m_droppedLinks++;
+                                                     return true;
+                                                 }),
+                                  m_deferredLinks.end());
+        IMNODEFLOW_PROFILE_LAP(lap, m_profile[ProfilePhase_Nodes]);
 
         // Update and draw links
-        for (auto &l: m_links) { if (!l.expired()) l.lock()->update(); }
+        // Indexed loop: a link deleting itself only leaves a hole
+        for (size_t i = 0; i < m_links.size(); i++) {
+            Link *l = m_links[i];
+            if (l && !l->isHidden())
+                l->update();
+        }
+        if (m_batchLinks)
+            m_linkBatch.render(draw_list);
+        IMNODEFLOW_PROFILE_LAP(lap, m_profile[ProfilePhase_Links]);
 
         // Links drop-off
+        bool openDroppedLinkPopUp = false;
         if (m_dragOut && ImGui::IsMouseReleased(ImGuiMouseButton_Left)) {
             if (!m_hovering) {
                 if (on_free_space() && m_droppedLinkPopUp) {
                     if (m_droppedLinkPupUpComboKey == ImGuiKey_None || ImGui::IsKeyDown(m_droppedLinkPupUpComboKey)) {
                         m_droppedLinkLeft = m_dragOut;
-                        ImGui::OpenPopup("DroppedLinkPopUp");
+                        openDroppedLinkPopUp = true;
                     }
                 }
             } else
@@ -312,6 +1014,13 @@ namespace ImFlow {
                 m_dragOut = nullptr;
         }
 
+        updateBoxSelection(draw_list);
+
+        // PopUps live outside the canvas, open and run them in host coordinates
+        m_context.suspend();
+        if (openDroppedLinkPopUp)
+            ImGui::OpenPopup("DroppedLinkPopUp");
+
         // Right-click PopUp
         if (m_rightClickPopUp && ImGui::IsMouseClicked(ImGuiMouseButton_Right) && ImGui::IsWindowHovered()) {
             m_hoveredNodeAux = m_hoveredNode;
@@ -327,14 +1036,424 @@ namespace ImFlow {
             m_droppedLinkPopUp(m_droppedLinkLeft);
             ImGui::EndPopup();
         }
+        m_context.resume();
 
         // Removing dead Links
-        m_links.erase(std::remove_if(m_links.begin(), m_links.end(),
-                                     [](const std::weak_ptr<Link> &l) { return l.expired(); }), m_links.end());
+        compactLinks();
+
+        // Background evaluations started by the nodes during this frame
+        flushAsync();
 
-        // Clearing recursion blacklist
-        m_pinRecursionBlacklist.clear();
+        // Values are pulled again next frame
+        m_evalEpoch++;
+        IMNODEFLOW_PROFILE_LAP(lap, m_profile[ProfilePhase_Interaction]);
 
         m_context.end();
+
+        // Keep drawing while something is moving or waiting, or if the hovered element changed
+        if (m_context.changed() || m_draggingNode || m_draggingNodeNext || m_dragOut || !m_asyncPins.empty() ||
+            getStreamPending() > 0 || m_hovering != hoveringPrev || m_hoveredNode != hoveredNodePrev)
+            m_dirty = true;
+        IMNODEFLOW_PROFILE_LAP(lap, m_profile[ProfilePhase_End]);
+        IMNODEFLOW_PROFILE_LAP(frame, m_profile[ProfilePhase_Frame]);
+    }
+
+    void ImNodeFlow::updateLogic() {
+        pollAsync();
+        finishStream();
+        applySelection();
+        eraseDestroyed();
+        compactLinks();
+        m_evalEpoch++;
+    }
+
+    void ImNodeFlow::queueAsync(Pin *pin, std::function<void()> task) {
+        std::lock_guard<std::mutex> lock(m_asyncQueueMutex);
+        m_asyncQueue.emplace_back(pin, std::move(task));
+    }
+
+    void ImNodeFlow::unwatchAsync(Pin *pin) {
+        m_asyncPins.erase(std::remove(m_asyncPins.begin(), m_asyncPins.end(), pin), m_asyncPins.end());
+        std::lock_guard<std::mutex> lock(m_asyncQueueMutex);
+        m_asyncQueue.erase(std::remove_if(m_asyncQueue.begin(), m_asyncQueue.end(),
+                                          [pin](const std::pair<Pin*, std::function<void()>> &q) { return q.first == pin; }),
+                           m_asyncQueue.end());
+    }
+
+    void ImNodeFlow::pollAsync() {
+        // Downstream invalidation happens here, on the UI thread, never while evaluate() runs
+        m_asyncPins.erase(std::remove_if(m_asyncPins.begin(), m_asyncPins.end(),
+                                         [](Pin *p) { return !p->pollAsync(); }), m_asyncPins.end());
+        flushAsync();
+    }
+
+    void ImNodeFlow::flushAsync() {
+        {
+            std::lock_guard<std::mutex> lock(m_asyncQueueMutex);
+            m_asyncSubmit.swap(m_asyncQueue);
+        }
+        for (auto &q: m_asyncSubmit) {
+            watchAsync(q.first);
+            m_asyncExecutor.submit(std::move(q.second));
+        }
+        m_asyncSubmit.clear();
+    }
+
+    void ImNodeFlow::eraseDestroyed() {
+        // Remove "toDelete" nodes
+        m_nodes.eraseIf([this](const NodeStorage::Entry &e) {
+            if (!e.second->toDestroy())
+                return false;
+            m_nodesIndex.remove(e.second.get());
+            m_dirty = true;
+            return true;
+        });
+    }
+
+    void ImNodeFlow::resetProfile() {
+        for (auto &n: m_nodes)
+            n.second->resetProfile();
+    }
+
+    void ImNodeFlow::drawProfiler(bool *open) {
+        static const char *phases[ProfilePhase_COUNT] = {"Async", "Begin", "Grid", "Stream", "Nodes", "Links",
+                                                         "Interaction", "End", "Frame"};
+        static const char *contextPhases[ContextPhase_COUNT] = {"Render", "Compose"};
+
+        if (!ImGui::Begin(("Profiler##" + m_name).c_str(), open)) {
+            ImGui::End();
+            return;
+        }
+#if !IMNODEFLOW_PROFILING
+        ImGui::TextDisabled("Build with IMNODEFLOW_PROFILING=1 to collect timings");
+#endif
+        for (int i = 0; i < ProfilePhase_COUNT; i++)
+            ImGui::Text("%-12s %8.3f ms", phases[i], m_profile[i].last * 1000.0);
+        for (int i = 0; i < ContextPhase_COUNT; i++)
+            ImGui::Text("  %-10s %8.3f ms", contextPhases[i], m_context.profile(i).last * 1000.0);
+        ImGui::Checkbox("Heatmap", &m_profileHeatmap);
+
+        // Slowest nodes of the last frame
+        ImGui::Separator();
+        std::vector<BaseNode *> slowest;
+        slowest.reserve(m_nodes.size());
+        for (auto &n: m_nodes)
+            slowest.push_back(n.second.get());
+        size_t shown = std::min<size_t>(10, slowest.size());
+        std::partial_sort(slowest.begin(), slowest.begin() + (std::ptrdiff_t)shown, slowest.end(),
+                          [](BaseNode *a, BaseNode *b) { return a->getProfile().update.last > b->getProfile().update.last; });
+        for (size_t i = 0; i < shown; i++) {
+            BaseNode *n = slowest[i];
+            ProfileStat eval;
+            for (auto &p: n->getOuts()) {
+                eval.seconds += p->getProfile().seconds;
+                eval.calls += p->getProfile().calls;
+            }
+            ImGui::Text("%-20s update %7.3f ms  draw %7.3f ms  eval %8.3f ms (%u)", n->getName().c_str(),
+                        n->getProfile().update.last * 1000.0, n->getProfile().draw.last * 1000.0,
+                        eval.seconds * 1000.0, eval.calls);
+        }
+        ImGui::End();
+    }
+
+    // -----------------------------------------------------------------------------------------------------------------
+    // SERIALIZATION
+
+    static constexpr uint32_t GraphMagic = 0x47464E49; // "INFG"
+    static constexpr uint32_t GraphVersion = 2;
+    static constexpr size_t NodeRecordSize = sizeof(uint64_t) + 2 * sizeof(ImVec2) + sizeof(uint32_t); // Without payload
+    static constexpr size_t LinkRecordSize = 2 * (sizeof(uint32_t) + sizeof(PinUID));
+
+    void ImNodeFlow::save(BinaryWriter &out) {
+        finishStream();
+
+        std::unordered_map<const BaseNode *, uint32_t> saved;
+        saved.reserve(m_nodes.size());
+
+        size_t header = out.size();
+        out.write(GraphMagic);
+        out.write(GraphVersion);
+        out.write<uint32_t>(0); // Node and link counts, patched at the end
+        out.write<uint32_t>(0);
+
+        for (auto &entry: m_nodes) {
+            BaseNode *node = entry.second.get();
+            if (node->toDestroy())
+                continue;
+            auto type = m_nodeTypeIds.find(std::type_index(typeid(*node)));
+            if (type == m_nodeTypeIds.end())
+                continue;
+            uint32_t index = (uint32_t)saved.size();
+            saved.emplace(node, index);
+
+            out.write(type->second);
+            out.write(node->getPos());
+            out.write(node->getFullSize()); // Size of the placeholder when streamed
+            size_t payload = out.size();
+            out.write<uint32_t>(0);
+            node->serialize(out);
+            out.patch(payload, (uint32_t)(out.size() - payload - sizeof(uint32_t)));
+        }
+
+        uint32_t links = 0;
+        for (Link *link: m_links) {
+            if (!link)
+                continue;
+            auto from = saved.find(link->left()->getParent());
+            auto to = saved.find(link->right()->getParent());
+            if (from == saved.end() || to == saved.end())
+                continue;
+            out.write(from->second);
+            out.write(link->left()->getUid());
+            out.write(to->second);
+            out.write(link->right()->getUid());
+            links++;
+        }
+
+        out.patch(header + 2 * sizeof(uint32_t), (uint32_t)saved.size());
+        out.patch(header + 3 * sizeof(uint32_t), links);
+    }
+
+    bool ImNodeFlow::saveFile(const std::string &path) {
+        BinaryWriter out;
+        save(out);
+        return writeFile(path, out.data());
+    }
+
+    bool ImNodeFlow::parseGraph(BinaryReader &in, GraphStream &graph) {
+        uint32_t magic = in.read<uint32_t>();
+        uint32_t version = in.read<uint32_t>();
+        uint32_t nodeCount = in.read<uint32_t>();
+        uint32_t linkCount = in.read<uint32_t>();
+        if (in.failed() || magic != GraphMagic || version != GraphVersion)
+            return false;
+        // Counts come from the data, don't reserve more than it can hold
+        if (nodeCount > in.remaining() / NodeRecordSize)
+            return false;
+
+        ImVec2 minSize(m_style.grid_size, m_style.grid_size);
+        graph.nodes.resize(nodeCount);
+        for (GraphNode &n: graph.nodes) {
+            n.type = in.read<uint64_t>();
+            ImVec2 pos = in.read<ImVec2>();
+            ImVec2 size = in.read<ImVec2>();
+            n.payloadSize = in.read<uint32_t>();
+            n.payload = in.readBytes(n.payloadSize);
+            if (in.failed())
+                return false;
+            n.rect = ImRect(pos, pos + ImMax(size, minSize));
+        }
+
+        if (linkCount > in.remaining() / LinkRecordSize)
+            return false;
+        graph.links.resize(linkCount);
+        for (GraphLink &l: graph.links) {
+            l.from = in.read<uint32_t>();
+            l.out = in.read<PinUID>();
+            l.to = in.read<uint32_t>();
+            l.in = in.read<PinUID>();
+        }
+        return !in.failed();
+    }
+
+    void ImNodeFlow::createGraphNode(GraphStream &graph, uint32_t i) {
+        GraphNode &n = graph.nodes[i];
+        auto factory = m_nodeFactories.find(n.type);
+        if (factory == m_nodeFactories.end())
+            return;
+        std::shared_ptr<BaseNode> node = factory->second(n.rect.Min);
+        BinaryReader payload(n.payload, n.payloadSize);
+        node->deserialize(payload);
+        n.uid = node->getUID();
+
+        if (graph.linkStart.empty())
+            return;
+        for (uint32_t k = graph.linkStart[i]; k < graph.linkStart[i + 1]; k++)
+            connectGraphLink(graph, graph.links[graph.linkIds[k]]);
+    }
+
+    void ImNodeFlow::connectGraphLink(GraphStream &graph, const GraphLink &link) {
+        if (link.from >= graph.nodes.size() || link.to >= graph.nodes.size())
+            return;
+        NodeUID from = graph.nodes[link.from].uid, to = graph.nodes[link.to].uid;
+        if (!from || !to)
+            return;
+        DeferredLink d = {from, link.out, to, link.in};
+        if (!connectDeferred(d))
+            m_deferredLinks.push_back(d);
+    }
+
+    bool ImNodeFlow::connectDeferred(const DeferredLink &link) {
+        // Looked up by UID: the user may have deleted nodes created earlier by the stream
+        if (!m_nodes.contains(link.from) || !m_nodes.contains(link.to))
+            return true;
+        auto &from = m_nodes.at(link.from), &to = m_nodes.at(link.to);
+        if (from->toDestroy() || to->toDestroy())
+            return true;
+        Pin *left = from->findOut(link.out);
+        if (!left)
+            left = from->findDynamicOut(link.out);
+        Pin *right = to->findIn(link.in);
+        if (!right)
+            right = to->findDynamicIn(link.in);
+        if (!left || !right)
+            return false;
+        right->restoreLink(left);
+        return true;
+    }
+
+    bool ImNodeFlow::load(BinaryReader &in) {
+        GraphStream graph;
+        if (!parseGraph(in, graph))
+            return false;
+
+        m_nodes.reserve(m_nodes.size() + graph.nodes.size());
+        for (uint32_t i = 0; i < graph.nodes.size(); i++)
+            createGraphNode(graph, i);
+
+        m_links.reserve(m_links.size() + graph.links.size());
+        for (const GraphLink &l: graph.links)
+            connectGraphLink(graph, l);
+        return true;
+    }
+
+    bool ImNodeFlow::loadFile(const std::string &path) {
+        MappedFile file(path);
+        if (!file.isOpen())
+            return false;
+        BinaryReader in(file.data(), file.size());
+        return load(in);
+    }
+
+    bool ImNodeFlow::beginStream(std::unique_ptr<GraphStream> graph, const void *data, size_t size) {
+        finishStream();
+        BinaryReader in(data, size);
+        if (!parseGraph(in, *graph))
+            return false;
+
+        // Links of each node, a link between two nodes is listed for both
+        uint32_t count = (uint32_t)graph->nodes.size();
+        graph->linkStart.assign(count + 1, 0);
+        for (const GraphLink &l: graph->links) {
+            if (l.from >= count || l.to >= count)
+                continue;
+            graph->linkStart[l.from + 1]++;
+            if (l.to != l.from)
+                graph->linkStart[l.to + 1]++;
+        }
+        for (uint32_t i = 0; i < count; i++)
+            graph->linkStart[i + 1] += graph->linkStart[i];
+        graph->linkIds.resize(graph->linkStart[count]);
+        std::vector<uint32_t> fill(graph->linkStart.begin(), graph->linkStart.end() - 1);
+        for (uint32_t k = 0; k < graph->links.size(); k++) {
+            const GraphLink &l = graph->links[k];
+            if (l.from >= count || l.to >= count)
+                continue;
+            graph->linkIds[fill[l.from]++] = k;
+            if (l.to != l.from)
+                graph->linkIds[fill[l.to]++] = k;
+        }
+
+        graph->pending.resize(count);
+        graph->index.setCellSize(m_style.grid_size);
+        for (uint32_t i = 0; i < count; i++) {
+            graph->pending[i] = count - 1 - i;
+            graph->index.update(i, graph->nodes[i].rect);
+        }
+        graph->remaining = count;
+        m_nodes.reserve(m_nodes.size() + count);
+        m_links.reserve(m_links.size() + graph->links.size());
+        if (count != 0)
+            m_stream = std::move(graph);
+        return true;
+    }
+
+    bool ImNodeFlow::stream(std::vector<char> data) {
+        auto graph = std::make_unique<GraphStream>();
+        graph->buffer = std::move(data);
+        const char *p = graph->buffer.data();
+        size_t size = graph->buffer.size();
+        return beginStream(std::move(graph), p, size);
+    }
+
+    bool ImNodeFlow::streamFile(const std::string &path) {
+        auto graph = std::make_unique<GraphStream>();
+        graph->file = std::make_shared<MappedFile>();
+        if (!graph->file->open(path))
+            return false;
+        const void *p = graph->file->data();
+        size_t size = graph->file->size();
+        return beginStream(std::move(graph), p, size);
+    }
+
+    void ImNodeFlow::finishStream() {
+        if (!m_stream)
+            return;
+        // Released first so that a node creating nodes doesn't see a half-done stream
+        std::unique_ptr<GraphStream> graph = std::move(m_stream);
+        for (auto it = graph->pending.rbegin(); it != graph->pending.rend(); ++it)
+            if (!graph->nodes[*it].created)
+                createGraphNode(*graph, *it);
+    }
+
+    void ImNodeFlow::streamNode(GraphStream &graph, uint32_t i) {
+        graph.nodes[i].created = true;
+        graph.index.remove(i);
+        graph.remaining--;
+        createGraphNode(graph, i);
+    }
+
+    void ImNodeFlow::updateStream(ImDrawList *draw_list) {
+        if (!m_stream)
+            return;
+        GraphStream &graph = *m_stream;
+
+        // Visible nodes closest to the center of the view first, then the rest in file order
+        ImVec2 center = m_visibleRect.GetCenter();
+        auto distance = [&graph, center](uint32_t i) {
+            ImVec2 d = graph.nodes[i].rect.GetCenter() - center;
+            return d.x * d.x + d.y * d.y;
+        };
+        size_t budget = m_streamBudget;
+        graph.index.query(m_visibleRect, graph.visible);
+        size_t count = std::min(budget, graph.visible.size());
+        if (count < graph.visible.size())
+            std::nth_element(graph.visible.begin(), graph.visible.begin() + (std::ptrdiff_t)count, graph.visible.end(),
+                             [&distance](uint32_t a, uint32_t b) { return distance(a) < distance(b); });
+        for (size_t k = 0; k < count; k++)
+            streamNode(graph, graph.visible[k]);
+        budget -= count;
+        while (budget > 0 && !graph.pending.empty()) {
+            uint32_t i = graph.pending.back();
+            graph.pending.pop_back();
+            if (graph.nodes[i].created)
+                continue;
+            streamNode(graph, i);
+            budget--;
+        }
+        if (graph.remaining == 0) {
+            m_stream.reset();
+            return;
+        }
+
+        // Only the pending nodes in view and their links: a link between two of them is drawn by its source node,
+        // unless the source is out of view
+        ImU32 color = m_style.colors.placeholder;
+        graph.visible.erase(std::remove_if(graph.visible.begin(), graph.visible.end(),
+                                           [&graph](uint32_t i) { return graph.nodes[i].created; }),
+                            graph.visible.end());
+        for (uint32_t i: graph.visible) {
+            const ImRect &r = graph.nodes[i].rect;
+            draw_list->AddRectFilled(grid2screen(r.Min), grid2screen(r.Max), color, NodeStyle::shared()->radius);
+            for (uint32_t k = graph.linkStart[i]; k < graph.linkStart[i + 1]; k++) {
+                const GraphLink &l = graph.links[graph.linkIds[k]];
+                const GraphNode &from = graph.nodes[l.from], &to = graph.nodes[l.to];
+                if (l.to == i && !from.created && m_visibleRect.Overlaps(from.rect))
+                    continue;
+                ImVec2 a(from.rect.Max.x, from.rect.GetCenter().y);
+                ImVec2 b(to.rect.Min.x, to.rect.GetCenter().y);
+                draw_list->AddLine(grid2screen(a), grid2screen(b), color);
+            }
+        }
     }
 }
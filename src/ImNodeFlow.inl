@@ -4,9 +4,8 @@
 
 namespace ImFlow
 {
-    inline void smart_bezier(const ImVec2& p1, const ImVec2& p2, ImU32 color, float thickness)
+    inline ImCubicBezierPoints smart_bezier_points(const ImVec2& p1, const ImVec2& p2)
     {
-        ImDrawList* dl = ImGui::GetWindowDrawList();
         float distance = sqrt(pow((p2.x - p1.x), 2.f) + pow((p2.y - p1.y), 2.f));
         float delta = distance * 0.45f;
         if (p2.x < p1.x) delta += 0.2f * (p1.x - p2.x);
@@ -15,20 +14,89 @@ namespace ImFlow
         ImVec2 p22 = p2 - ImVec2(delta, vert);
         if (p2.x < p1.x - 50.f) delta *= -1.f;
         ImVec2 p11 = p1 + ImVec2(delta, vert);
-        dl->AddBezierCubic(p1, p11, p22, p2, color, thickness);
+        return {p1, p11, p22, p2};
+    }
+
+    inline void smart_bezier(const ImVec2& p1, const ImVec2& p2, ImU32 color, float thickness)
+    {
+        ImDrawList* dl = ImGui::GetWindowDrawList();
+        ImCubicBezierPoints b = smart_bezier_points(p1, p2);
+        dl->AddBezierCubic(b.P0, b.P1, b.P2, b.P3, color, thickness);
     }
 
     inline bool smart_bezier_collider(const ImVec2& p, const ImVec2& p1, const ImVec2& p2, float radius)
     {
-        float distance = sqrt(pow((p2.x - p1.x), 2.f) + pow((p2.y - p1.y), 2.f));
-        float delta = distance * 0.45f;
-        if (p2.x < p1.x) delta += 0.2f * (p1.x - p2.x);
-        // float vert = (p2.x < p1.x - 20.f) ? 0.062f * distance * (p2.y - p1.y) * 0.005f : 0.f;
-        float vert = 0.f;
-        ImVec2 p22 = p2 - ImVec2(delta, vert);
-        if (p2.x < p1.x - 50.f) delta *= -1.f;
-        ImVec2 p11 = p1 + ImVec2(delta, vert);
-        return ImProjectOnCubicBezier(p, p1, p11, p22, p2).Distance < radius;
+        ImCubicBezierPoints curve = smart_bezier_points(p1, p2);
+        ImRect bounds = ImCubicBezierBoundingRect(curve);
+        bounds.Expand(radius);
+        return smart_bezier_collider(p, curve, bounds, radius);
+    }
+
+    inline bool smart_bezier_collider(const ImVec2& p, const ImCubicBezierPoints& curve, const ImRect& bounds, float radius)
+    {
+        if (p.x < bounds.Min.x || p.y < bounds.Min.y || p.x > bounds.Max.x || p.y > bounds.Max.y)
+            return false;
+        return smart_bezier_distance(p, curve) < radius;
+    }
+
+    inline float smart_bezier_distance(const ImVec2& p, const ImCubicBezierPoints& curve)
+    {
+        // Step 1: Coarse check, roughly one sample every 16 units along the control polygon
+        float polygon = ImLength(curve.P1 - curve.P0) + ImLength(curve.P2 - curve.P1) + ImLength(curve.P3 - curve.P2);
+        int samples = ImClamp((int)(polygon / 16.f), 8, 64);
+        float bestT = 0.f;
+        float bestD = FLT_MAX;
+        for (int i = 0; i <= samples; i++)
+        {
+            float t = (float)i / (float)samples;
+            ImVec2 s = p - ImCubicBezier(curve.P0, curve.P1, curve.P2, curve.P3, t);
+            float d = ImDot(s, s);
+            if (d < bestD)
+            {
+                bestD = d;
+                bestT = t;
+            }
+        }
+
+        // Step 2: Newton iterations on (B(t) - p) . B'(t) = 0
+        ImVec2 a = curve.P2 - curve.P1 * 2.f + curve.P0;
+        ImVec2 b = curve.P3 - curve.P2 * 2.f + curve.P1;
+        float t = bestT;
+        for (int i = 0; i < 4; i++)
+        {
+            ImVec2 s = ImCubicBezier(curve.P0, curve.P1, curve.P2, curve.P3, t) - p;
+            ImVec2 d1 = ImCubicBezierDt(curve.P0, curve.P1, curve.P2, curve.P3, t);
+            ImVec2 d2 = a * (6.f * (1.f - t)) + b * (6.f * t);
+            float den = ImDot(d1, d1) + ImDot(s, d2);
+            if (den <= 0.f)
+                break;
+            float next = ImClamp(t - ImDot(s, d1) / den, 0.f, 1.f);
+            if (ImFabs(next - t) < 1e-5f)
+                break;
+            t = next;
+        }
+        ImVec2 s = p - ImCubicBezier(curve.P0, curve.P1, curve.P2, curve.P3, t);
+        return ImSqrt(ImMin(bestD, ImDot(s, s)));
+    }
+
+    inline bool LinkGeometry::update(const ImVec2& start, const ImVec2& end, float scale)
+    {
+        // Tolerance is squared by the subdivision, the deviation on screen grows linearly with the scale
+        float tessTol = ImSqrt(ImGui::GetStyle().CurveTessellationTol) / scale;
+        if (m_valid && start == m_start && end == m_end && scale == m_scale && tessTol == m_tessTol)
+            return false;
+        m_start = start;
+        m_end = end;
+        m_scale = scale;
+        m_tessTol = tessTol;
+        m_valid = true;
+
+        curve = smart_bezier_points(start, end);
+        bounds = ImCubicBezierBoundingRect(curve);
+        polyline.clear();
+        auto collect = [this](const ImCubicBezierSubdivideSample& s) { polyline.push_back(s.Point); };
+        ImCubicBezierSubdivide(collect, curve, tessTol);
+        return true;
     }
 
     // -----------------------------------------------------------------------------------------------------------------
@@ -39,18 +107,27 @@ namespace ImFlow
     {
         static_assert(std::is_base_of<BaseNode, T>::value, "Pushed type is not a subclass of BaseNode!");
 
-        std::shared_ptr<T> n = std::make_shared<T>(std::forward<Params>(args)...);
+        std::shared_ptr<T> n = std::allocate_shared<T>(PoolAllocator<T>(), std::forward<Params>(args)...);
+        n->setUID(m_nodes.insert(n));
         n->setPos(pos);
         n->setHandler(this);
         if (!n->getStyle())
-            n->setStyle(NodeStyle::cyan());
-
-        auto uid = reinterpret_cast<uintptr_t>(n.get());
-        n->setUID(uid);
-        m_nodes[uid] = n;
+            n->setStyle(NodeStyle::shared());
+        m_dirty = true;
         return n;
     }
 
+    template<typename T>
+    void ImNodeFlow::registerNodeType(const std::string& name)
+    {
+        static_assert(std::is_base_of<BaseNode, T>::value, "Registered type is not a subclass of BaseNode!");
+
+        uint64_t id = fnv1a(name.data(), name.size());
+        IM_ASSERT(m_nodeFactories.count(id) == 0 && "Node type name already registered");
+        m_nodeFactories[id] = [this](const ImVec2& pos) -> std::shared_ptr<BaseNode> { return addNode<T>(pos); };
+        m_nodeTypeIds[std::type_index(typeid(T))] = id;
+    }
+
     template<typename T, typename... Params>
     std::shared_ptr<T> ImNodeFlow::placeNodeAt(const ImVec2& pos, Params&&... args)
     {
@@ -75,29 +152,22 @@ namespace ImFlow
     template<typename T, typename U>
     std::shared_ptr<InPin<T>> BaseNode::addIN_uid(const U& uid, const std::string& name, T defReturn, std::function<bool(Pin*, Pin*)> filter, std::shared_ptr<PinStyle> style)
     {
-        PinUID h = std::hash<U>{}(uid);
-        auto p = std::make_shared<InPin<T>>(h, name, defReturn, std::move(filter), std::move(style), this, &m_inf);
+        PinUID h = pinHash(uid);
+        auto p = std::allocate_shared<InPin<T>>(PoolAllocator<InPin<T>>(), h, name, defReturn, std::move(filter), std::move(style), this, &m_inf);
         m_ins.emplace_back(p);
+        m_insIndex.insert(h, p.get());
         return p;
     }
 
     template<typename U>
     void BaseNode::dropIN(const U& uid)
     {
-        PinUID h = std::hash<U>{}(uid);
-        for (auto it = m_ins.begin(); it != m_ins.end(); it++)
-        {
-            if (it->get()->getUid() == h)
-            {
-                m_ins.erase(it);
-                return;
-            }
-        }
+        dropPin(m_ins, m_insIndex, pinHash(uid));
     }
 
     inline void BaseNode::dropIN(const char* uid)
     {
-        dropIN<std::string>(uid);
+        dropPin(m_ins, m_insIndex, pinHash(uid));
     }
 
     template<typename T>
@@ -109,17 +179,16 @@ namespace ImFlow
     template<typename T, typename U>
     const T& BaseNode::showIN_uid(const U& uid, const std::string& name, T defReturn, std::function<bool(Pin*, Pin*)> filter, std::shared_ptr<PinStyle> style)
     {
-        PinUID h = std::hash<U>{}(uid);
-        for (std::pair<int, std::shared_ptr<Pin>>& p : m_dynamicIns)
+        PinUID h = pinHash(uid);
+        if (size_t* i = m_dynamicInsIndex.find(h))
         {
-            if (p.second->getUid() == h)
-            {
-                p.first = 1;
-                return static_cast<InPin<T>*>(p.second.get())->val();
-            }
+            std::pair<int, std::shared_ptr<Pin>>& p = m_dynamicIns[*i];
+            p.first = 1;
+            return static_cast<InPin<T>*>(p.second.get())->val();
         }
 
-        m_dynamicIns.emplace_back(std::make_pair(1, std::make_shared<InPin<T>>(h, name, defReturn, std::move(filter), std::move(style), this, &m_inf)));
+        m_dynamicIns.emplace_back(std::make_pair(1, std::allocate_shared<InPin<T>>(PoolAllocator<InPin<T>>(), h, name, defReturn, std::move(filter), std::move(style), this, &m_inf)));
+        m_dynamicInsIndex.insert(h, m_dynamicIns.size() - 1);
         return static_cast<InPin<T>*>(m_dynamicIns.back().second.get())->val();
     }
 
@@ -132,29 +201,22 @@ namespace ImFlow
     template<typename T, typename U>
     std::shared_ptr<OutPin<T>> BaseNode::addOUT_uid(const U& uid, const std::string& name, std::shared_ptr<PinStyle> style)
     {
-        PinUID h = std::hash<U>{}(uid);
-        auto p = std::make_shared<OutPin<T>>(h, name, std::move(style), this, &m_inf);
+        PinUID h = pinHash(uid);
+        auto p = std::allocate_shared<OutPin<T>>(PoolAllocator<OutPin<T>>(), h, name, std::move(style), this, &m_inf);
         m_outs.emplace_back(p);
+        m_outsIndex.insert(h, p.get());
         return p;
     }
 
     template<typename U>
     void BaseNode::dropOUT(const U& uid)
     {
-        PinUID h = std::hash<U>{}(uid);
-        for (auto it = m_outs.begin(); it != m_outs.end(); it++)
-        {
-            if (it->get()->getUid() == h)
-            {
-                m_outs.erase(it);
-                return;
-            }
-        }
+        dropPin(m_outs, m_outsIndex, pinHash(uid));
     }
 
     inline void BaseNode::dropOUT(const char* uid)
     {
-        dropOUT<std::string>(uid);
+        dropPin(m_outs, m_outsIndex, pinHash(uid));
     }
 
     template<typename T>
@@ -166,65 +228,75 @@ namespace ImFlow
     template<typename T, typename U>
     void BaseNode::showOUT_uid(const U& uid, const std::string& name, std::function<T()> behaviour, std::shared_ptr<PinStyle> style)
     {
-        PinUID h = std::hash<U>{}(uid);
-        for (std::pair<int, std::shared_ptr<Pin>>& p : m_dynamicOuts)
+        PinUID h = pinHash(uid);
+        if (size_t* i = m_dynamicOutsIndex.find(h))
         {
-            if (p.second->getUid() == h)
-            {
-                p.first = 2;
-                static_cast<OutPin<T>*>(m_dynamicOuts.back().second.get())->behaviour(std::move(behaviour));
-                return;
-            }
+            std::pair<int, std::shared_ptr<Pin>>& p = m_dynamicOuts[*i];
+            p.first = 2;
+            static_cast<OutPin<T>*>(p.second.get())->behaviour(std::move(behaviour));
+            return;
         }
 
-        m_dynamicOuts.emplace_back(std::make_pair(2, std::make_shared<OutPin<T>>(h, name, std::move(style), this, &m_inf)));
+        m_dynamicOuts.emplace_back(std::make_pair(2, std::allocate_shared<OutPin<T>>(PoolAllocator<OutPin<T>>(), h, name, std::move(style), this, &m_inf)));
+        m_dynamicOutsIndex.insert(h, m_dynamicOuts.size() - 1);
         static_cast<OutPin<T>*>(m_dynamicOuts.back().second.get())->behaviour(std::move(behaviour));
     }
 
     template<typename T, typename U>
     const T& BaseNode::getInVal(const U& uid)
     {
-        PinUID h = std::hash<U>{}(uid);
-        auto it = std::find_if(m_ins.begin(), m_ins.end(), [&h](std::shared_ptr<Pin>& p)
-                            { return p->getUid() == h; });
-        assert(it != m_ins.end() && "Pin UID not found!");
-        return static_cast<InPin<T>*>(it->get())->val();
+        return static_cast<InPin<T>*>(findPin(m_insIndex, pinHash(uid)))->val();
     }
 
     template<typename T>
     const T& BaseNode::getInVal(const char* uid)
     {
-        return getInVal<T, std::string>(uid);
+        return static_cast<InPin<T>*>(findPin(m_insIndex, pinHash(uid)))->val();
+    }
+
+    template<typename T>
+    const T& BaseNode::getInVal(PinID uid)
+    {
+        return static_cast<InPin<T>*>(findPin(m_insIndex, uid.hash))->val();
     }
 
     template<typename U>
     Pin* BaseNode::inPin(const U& uid)
     {
-        PinUID h = std::hash<U>{}(uid);
-        auto it = std::find_if(m_ins.begin(), m_ins.end(), [&h](std::shared_ptr<Pin>& p)
-                            { return p->getUid() == h; });
-        assert(it != m_ins.end() && "Pin UID not found!");
-        return it->get();
+        return findPin(m_insIndex, pinHash(uid));
     }
 
     inline Pin* BaseNode::inPin(const char* uid)
     {
-        return inPin<std::string>(uid);
+        return findPin(m_insIndex, pinHash(uid));
+    }
+
+    inline Pin* BaseNode::inPin(PinID uid)
+    {
+        return findPin(m_insIndex, uid.hash);
     }
 
     template<typename U>
     Pin* BaseNode::outPin(const U& uid)
     {
-        PinUID h = std::hash<U>{}(uid);
-        auto it = std::find_if(m_outs.begin(), m_outs.end(), [&h](std::shared_ptr<Pin>& p)
-                            { return p->getUid() == h; });
-        assert(it != m_outs.end() && "Pin UID not found!");
-        return it->get();
+        return findPin(m_outsIndex, pinHash(uid));
     }
 
     inline Pin* BaseNode::outPin(const char* uid)
     {
-        return outPin<std::string>(uid);
+        return findPin(m_outsIndex, pinHash(uid));
+    }
+
+    inline Pin* BaseNode::outPin(PinID uid)
+    {
+        return findPin(m_outsIndex, uid.hash);
+    }
+
+    inline Pin* BaseNode::findPin(PinIndex<Pin*>& index, PinUID h)
+    {
+        Pin** p = index.find(h);
+        assert(p && "Pin UID not found!");
+        return *p;
     }
 
     // -----------------------------------------------------------------------------------------------------------------
@@ -246,6 +318,11 @@ namespace ImFlow
                 draw_list->AddCircle(pinPoint(), m_style->socket_radius, m_style->color, m_style->socket_shape, m_style->socket_thickness);
         }
 
+        if (isPending())
+            draw_list->AddCircle(pinPoint(), m_style->socket_hovered_radius + 2.f, m_style->extra.pending_color, 0, 1.5f);
+        else if (m_highlight == (*m_inf)->getHighlightEpoch())
+            draw_list->AddCircle(pinPoint(), m_style->socket_hovered_radius + 2.f, m_style->extra.compatible_color, 0, 1.5f);
+
         if (ImGui::IsMouseHoveringRect(tl, br))
             (*m_inf)->hovering(this);
     }
@@ -254,11 +331,26 @@ namespace ImFlow
     {
         ImDrawList* draw_list = ImGui::GetWindowDrawList();
 
-        if (ImGui::IsItemHovered())
-            draw_list->AddRectFilled(m_pos - m_style->extra.padding, m_pos + m_size + m_style->extra.padding, m_style->extra.bg_hover_color, m_style->extra.bg_radius);
-        else
-            draw_list->AddRectFilled(m_pos - m_style->extra.padding, m_pos + m_size + m_style->extra.padding, m_style->extra.bg_color, m_style->extra.bg_radius);
-        draw_list->AddRect(m_pos - m_style->extra.padding, m_pos + m_size + m_style->extra.padding, m_style->extra.border_color, m_style->extra.bg_radius, 0, m_style->extra.border_thickness);
+        const PinStyleExtras& extra = m_style->extra;
+
+        // Fully transparent by default, nothing to draw
+        ImU32 bg = ImGui::IsItemHovered() ? extra.bg_hover_color : extra.bg_color;
+        if (bg & IM_COL32_A_MASK)
+            draw_list->AddRectFilled(m_pos - extra.padding, m_pos + m_size + extra.padding, bg, extra.bg_radius);
+        if (extra.border_color & IM_COL32_A_MASK)
+            draw_list->AddRect(m_pos - extra.padding, m_pos + m_size + extra.padding, extra.border_color, extra.bg_radius, 0, extra.border_thickness);
+    }
+
+    inline bool Pin::drawDot()
+    {
+        ImVec2 r(m_style->socket_radius, m_style->socket_radius);
+        ImGui::GetWindowDrawList()->AddRectFilled(pinPoint() - r, pinPoint() + r, m_style->color);
+        if (m_highlight == (*m_inf)->getHighlightEpoch())
+            ImGui::GetWindowDrawList()->AddRect(pinPoint() - r * 2.f, pinPoint() + r * 2.f, m_style->extra.compatible_color);
+        if (!ImGui::IsMouseHoveringRect(pinPoint() - r, pinPoint() + r))
+            return false;
+        (*m_inf)->hovering(this);
+        return true;
     }
 
     inline void Pin::update()
@@ -275,9 +367,9 @@ namespace ImFlow
             return;
         }
 
-        ImGui::SetCursorPos(m_pos);
-        ImGui::Text("%s", m_name.c_str());
-        m_size = ImGui::GetItemRectSize();
+        ImGui::SetCursorScreenPos(m_pos);
+        m_nameText.item(m_name, ImGui::GetColorU32(ImGuiCol_Text));
+        m_size = m_nameText.size(m_name);
 
         drawDecoration();
         drawSocket();
@@ -292,10 +384,10 @@ namespace ImFlow
     template<class T>
     const T& InPin<T>::val()
     {
-        if(!m_link)
+        if (!m_source)
             return m_emptyVal;
 
-        return reinterpret_cast<OutPin<T>*>(m_link->left())->val();
+        return m_source->val();
     }
 
     template<class T>
@@ -309,14 +401,64 @@ namespace ImFlow
 
         if (m_link && m_link->left() == other)
         {
-            m_link.reset();
+            deleteLink();
             return;
         }
 
-        if (!m_filter(other, this)) // Check Filter
+        if (!accepts(other)) // Check Filter
+            return;
+
+        restoreLink(other);
+        m_parent->invalidate();
+    }
+
+    template<class T>
+    bool InPin<T>::canConnect(Pin *other)
+    {
+        if (other == this || other->getType() == PinType_Input)
+            return false;
+        if (m_parent == other->getParent() && !m_allowSelfConnection)
+            return false;
+        return accepts(other);
+    }
+
+    template<class T>
+    bool InPin<T>::accepts(Pin *out)
+    {
+        switch (m_filterKind)
+        {
+            case FilterKind_Any:
+                return true;
+            // Ids never collide, but a mismatch may be the same type seen from another module
+            case FilterKind_SameType:
+                return out->getTypeID() == m_typeId || out->getDataType() == typeid(T);
+            case FilterKind_Mask:
+                return (out->getTypeID() < 64 && (m_filterMask >> out->getTypeID() & 1) != 0) || m_filter(out, this);
+            default:
+                return m_filter(out, this);
+        }
+    }
+
+    template<class T>
+    void InPin<T>::classifyFilter()
+    {
+        using Filter = bool(*)(Pin*, Pin*);
+        const Filter* f = m_filter.template target<Filter>();
+        if (!f)
             return;
+        if (*f == &ConnectionFilter::any)
+            m_filterKind = FilterKind_Any;
+        else if (*f == &ConnectionFilter::sameType)
+            m_filterKind = FilterKind_SameType;
+        else if (*f == &ConnectionFilter::numbers && (m_filterMask = typeMask<double, float, int>()) != 0)
+            m_filterKind = FilterKind_Mask;
+    }
 
-        m_link = std::make_shared<Link>(other, this, (*m_inf));
+    template<class T>
+    void InPin<T>::restoreLink(Pin *other)
+    {
+        m_link = std::allocate_shared<Link>(PoolAllocator<Link>(), other, this, (*m_inf));
+        m_source = dynamic_cast<OutPin<T>*>(other); // nullptr if the filter let a different type through
         other->setLink(m_link);
         (*m_inf)->addLink(m_link);
     }
@@ -327,16 +469,104 @@ namespace ImFlow
     template<class T>
     const T &OutPin<T>::val()
     {
-        std::string s = std::to_string(m_uid) + std::to_string(m_parent->getUID());
-        if (std::find((*m_inf)->get_recursion_blacklist().begin(), (*m_inf)->get_recursion_blacklist().end(), s) == (*m_inf)->get_recursion_blacklist().end())
+        if (m_asyncBehaviour)
+            return asyncVal();
+
+        if ((*m_inf)->isLazyEvaluation())
+        {
+            // Cleared before the call so that a cycle gets the cached value instead of recursing
+            if (m_dirty)
+            {
+                m_dirty = false;
+                m_evaluating = true;
+                compute();
+                m_evaluating = false;
+            }
+            return m_val;
+        }
+
+        // Once per epoch, a cycle gets the value of the previous evaluation
+        unsigned long long epoch = (*m_inf)->getEvalEpoch();
+        if (m_evaluating || m_epoch == epoch)
+            return m_val;
+
+        m_epoch = epoch;
+        m_evaluating = true;
+        compute();
+        m_evaluating = false;
+        return m_val;
+    }
+
+    template<class T>
+    void OutPin<T>::compute()
+    {
+        IMNODEFLOW_PROFILE_SCOPE(m_profile);
+        if (m_inPlaceBehaviour)
+            m_inPlaceBehaviour(m_val);
+        else if (m_behaviour)
+            m_val = m_behaviour(); // Move-assigned from the returned temporary
+    }
+
+    template<class T>
+    const T &OutPin<T>::asyncVal()
+    {
+        // Results are collected by the handler on the UI thread, this may run on an evaluate() worker
+        if (m_evaluating || m_inFlight)
+            return m_val;
+        unsigned long long epoch = (*m_inf)->getEvalEpoch();
+        if ((*m_inf)->isLazyEvaluation() ? !m_dirty : m_epoch == epoch)
+            return m_val;
+
+        m_dirty = false;
+        m_epoch = epoch;
+        m_evaluating = true;
+        std::function<T()> task;
         {
-            (*m_inf)->get_recursion_blacklist().emplace_back(s);
-            m_val = m_behaviour();
+            IMNODEFLOW_PROFILE_SCOPE(m_profile); // Only the gathering, the task runs elsewhere
+            task = m_asyncBehaviour(); // Inputs are read here, on the calling thread
         }
+        m_evaluating = false;
+        if (!task)
+            return m_val;
 
+        m_inFlight = true;
+        (*m_inf)->queueAsync(this, [slot = m_slot, task = std::move(task)]()
+        {
+            slot->value = task();
+            slot->ready.store(true, std::memory_order_release);
+        });
         return m_val;
     }
 
+    template<class T>
+    bool OutPin<T>::pollAsync()
+    {
+        if (!m_inFlight)
+            return false;
+        if (!m_slot->ready.load(std::memory_order_acquire))
+            return true;
+        // Swapping hands the old storage back to the task, not worth it for plain data
+        if constexpr (std::is_trivially_copyable<T>::value)
+            m_val = m_slot->value;
+        else
+            std::swap(m_val, m_slot->value);
+        m_slot->ready.store(false, std::memory_order_relaxed);
+        m_inFlight = false;
+        for (Link* l = m_links.head; l; l = l->next())
+            l->right()->getParent()->invalidate();
+        return false;
+    }
+
+    template<class T>
+    void OutPin<T>::invalidate()
+    {
+        if (m_dirty)
+            return;
+        m_dirty = true;
+        for (Link* l = m_links.head; l; l = l->next())
+            l->right()->getParent()->invalidate();
+    }
+
     template<class T>
     void OutPin<T>::createLink(ImFlow::Pin *other)
     {
@@ -349,13 +579,6 @@ namespace ImFlow
     template<class T>
     void OutPin<T>::setLink(std::shared_ptr<Link>& link)
     {
-        m_links.emplace_back(link);
-    }
-
-    template<class T>
-    void OutPin<T>::deleteLink()
-    {
-        m_links.erase(std::remove_if(m_links.begin(), m_links.end(),
-                                     [](const std::weak_ptr<Link>& l) { return l.expired(); }), m_links.end());
+        link->attach(&m_links);
     }
 }
@@ -0,0 +1,162 @@
+#pragma once
+
+#include <cstring>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <type_traits>
+
+/**
+ * @brief Append-only binary buffer
+ * @details Values are written in native byte order with no padding.
+ */
+class BinaryWriter
+{
+public:
+    /**
+     * @brief <BR>Write a plain value
+     * @tparam T Trivially copyable type
+     * @param v Value to be written
+     */
+    template<typename T>
+    void write(const T& v)
+    {
+        static_assert(std::is_trivially_copyable<T>::value, "Only trivially copyable types can be written raw");
+        writeBytes(&v, sizeof(T));
+    }
+
+    /**
+     * @brief <BR>Overwrite a plain value written earlier
+     * @details Used to fill in sizes once the data they count was written.
+     * @tparam T Trivially copyable type
+     * @param offset Position of the value in the buffer
+     * @param v New value
+     */
+    template<typename T>
+    void patch(size_t offset, const T& v)
+    {
+        static_assert(std::is_trivially_copyable<T>::value, "Only trivially copyable types can be written raw");
+        std::memcpy(m_data.data() + offset, &v, sizeof(T));
+    }
+
+    /**
+     * @brief <BR>Write a length-prefixed string
+     * @param s String to be written
+     */
+    void writeString(const std::string& s)
+    {
+        write((uint32_t)s.size());
+        writeBytes(s.data(), s.size());
+    }
+
+    void writeBytes(const void* p, size_t n)
+    {
+        const char* c = static_cast<const char*>(p);
+        m_data.insert(m_data.end(), c, c + n);
+    }
+
+    void reserve(size_t n) { m_data.reserve(n); }
+    [[nodiscard]] size_t size() const { return m_data.size(); }
+    [[nodiscard]] const std::vector<char>& data() const { return m_data; }
+    std::vector<char>& data() { return m_data; }
+private:
+    std::vector<char> m_data;
+};
+
+/**
+ * @brief Bounds-checked reader over a memory block
+ * @details Does not own the memory. Reading past the end fails without touching the output and marks the reader
+ *          as failed, so a whole record can be read before checking.
+ */
+class BinaryReader
+{
+public:
+    BinaryReader(const void* data, size_t size) : m_data(static_cast<const char*>(data)), m_size(size) {}
+
+    /**
+     * @brief <BR>Read a plain value
+     * @tparam T Trivially copyable type
+     * @param v Destination of the value
+     * @return [TRUE] if there were enough bytes left
+     */
+    template<typename T>
+    bool read(T& v)
+    {
+        static_assert(std::is_trivially_copyable<T>::value, "Only trivially copyable types can be read raw");
+        const char* p = readBytes(sizeof(T));
+        if (!p)
+            return false;
+        std::memcpy(&v, p, sizeof(T));
+        return true;
+    }
+
+    /**
+     * @brief <BR>Read a plain value
+     * @tparam T Trivially copyable type
+     * @return The value, or a value-initialized one on failure
+     */
+    template<typename T>
+    T read()
+    {
+        T v{};
+        read(v);
+        return v;
+    }
+
+    /**
+     * @brief <BR>Read a length-prefixed string
+     * @param s Destination of the string
+     * @return [TRUE] if there were enough bytes left
+     */
+    bool readString(std::string& s)
+    {
+        uint32_t n = 0;
+        if (!read(n))
+            return false;
+        const char* p = readBytes(n);
+        if (!p)
+            return false;
+        s.assign(p, n);
+        return true;
+    }
+
+    /**
+     * @brief <BR>Consume raw bytes
+     * @param n Number of bytes
+     * @return Pointer to the bytes inside the block, nullptr if there were not enough left
+     */
+    const char* readBytes(size_t n)
+    {
+        if (m_failed || m_size - m_pos < n)
+        {
+            m_failed = true;
+            return nullptr;
+        }
+        const char* p = m_data + m_pos;
+        m_pos += n;
+        return p;
+    }
+
+    /**
+     * @brief <BR>Split off a reader over the next bytes
+     * @param n Number of bytes
+     * @return Reader limited to the bytes, empty and failed if there were not enough left
+     */
+    BinaryReader sub(size_t n)
+    {
+        const char* p = readBytes(n);
+        BinaryReader r(p, p ? n : 0);
+        r.m_failed = !p;
+        return r;
+    }
+
+    [[nodiscard]] bool failed() const { return m_failed; }
+    [[nodiscard]] size_t position() const { return m_pos; }
+    [[nodiscard]] size_t remaining() const { return m_size - m_pos; }
+private:
+    const char* m_data;
+    size_t m_size;
+    size_t m_pos = 0;
+    bool m_failed = false;
+};
@@ -1,7 +1,17 @@
 #pragma once
 
+#include <cstring>
 #include <imgui.h>
 #include <imgui_internal.h>
+#include "profiler.h"
+
+#if !defined(IMNODEFLOW_DISABLE_SIMD) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#define IMNODEFLOW_SSE2
+#include <emmintrin.h>
+#elif !defined(IMNODEFLOW_DISABLE_SIMD) && (defined(__ARM_NEON) || defined(__ARM_NEON__))
+#define IMNODEFLOW_NEON
+#include <arm_neon.h>
+#endif
 
 inline static void CopyIOEvents(ImGuiContext* src, ImGuiContext* dst, ImVec2 origin, float scale)
 {
@@ -16,30 +26,126 @@ inline static void CopyIOEvents(ImGuiContext* src, ImGuiContext* dst, ImVec2 ori
     }
 }
 
+// Reset the keys and buttons of a pooled context to the ones held on the host, it may still hold another canvas' state.
+// Those pressed this frame are left to the events CopyIOEvents() replays, so that they still register as pressed.
+inline static void CopyHeldInput(ImGuiContext* src, ImGuiContext* dst)
+{
+    dst->IO.ClearInputKeys();
+    dst->IO.ClearInputMouse();
+    for (int k = ImGuiKey_NamedKey_BEGIN; k < ImGuiKey_NamedKey_END; k++)
+    {
+        const ImGuiKeyData* held = ImGui::GetKeyData(src, (ImGuiKey)k);
+        if (!held->Down || held->DownDuration <= 0.f)
+            continue;
+        ImGuiKeyData* key = ImGui::GetKeyData(dst, (ImGuiKey)k);
+        key->Down = true;
+        key->DownDuration = held->DownDuration;
+        key->DownDurationPrev = held->DownDurationPrev;
+    }
+    ImGuiIO& io = dst->IO;
+    io.KeyCtrl = ImGui::GetKeyData(dst, ImGuiMod_Ctrl)->Down;
+    io.KeyShift = ImGui::GetKeyData(dst, ImGuiMod_Shift)->Down;
+    io.KeyAlt = ImGui::GetKeyData(dst, ImGuiMod_Alt)->Down;
+    io.KeySuper = ImGui::GetKeyData(dst, ImGuiMod_Super)->Down;
+    io.KeyMods = (io.KeyCtrl ? ImGuiMod_Ctrl : 0) | (io.KeyShift ? ImGuiMod_Shift : 0) |
+                 (io.KeyAlt ? ImGuiMod_Alt : 0) | (io.KeySuper ? ImGuiMod_Super : 0);
+    for (int b = 0; b < IM_ARRAYSIZE(io.MouseDown); b++)
+    {
+        if (!src->IO.MouseDown[b] || src->IO.MouseDownDuration[b] <= 0.f)
+            continue;
+        io.MouseDown[b] = true;
+        io.MouseDownDuration[b] = src->IO.MouseDownDuration[b];
+    }
+}
+
+// Copy "count" vertices applying "pos * scale + origin"
+inline static void TransformVertices(ImDrawVert* dst, const ImDrawVert* src, int count, ImVec2 origin, float scale)
+{
+    if (dst != src)
+        memcpy(dst, src, (size_t)count * sizeof(ImDrawVert));
+    int i = 0;
+#if defined(IMNODEFLOW_SSE2)
+    // Two positions per register, uv and col are already in place
+    const __m128 s = _mm_set1_ps(scale);
+    const __m128 o = _mm_setr_ps(origin.x, origin.y, origin.x, origin.y);
+    for (; i + 1 < count; i += 2)
+    {
+        __m128 p = _mm_setzero_ps();
+        p = _mm_loadl_pi(p, reinterpret_cast<const __m64*>(&dst[i].pos));
+        p = _mm_loadh_pi(p, reinterpret_cast<const __m64*>(&dst[i + 1].pos));
+        p = _mm_add_ps(_mm_mul_ps(p, s), o);
+        _mm_storel_pi(reinterpret_cast<__m64*>(&dst[i].pos), p);
+        _mm_storeh_pi(reinterpret_cast<__m64*>(&dst[i + 1].pos), p);
+    }
+#elif defined(IMNODEFLOW_NEON)
+    const float32x2_t o = vld1_f32(&origin.x);
+    for (; i < count; i++)
+        vst1_f32(&dst[i].pos.x, vmla_n_f32(o, vld1_f32(&dst[i].pos.x), scale));
+#endif
+    for (; i < count; i++)
+        dst[i].pos = dst[i].pos * scale + origin;
+}
+
+// Copy "count" indices adding "base" to each one
+inline static void RebaseIndices(ImDrawIdx* dst, const ImDrawIdx* src, int count, unsigned int base)
+{
+    if (base == 0)
+    {
+        memcpy(dst, src, (size_t)count * sizeof(ImDrawIdx));
+        return;
+    }
+    int i = 0;
+#if defined(IMNODEFLOW_SSE2)
+    if (sizeof(ImDrawIdx) == 2)
+    {
+        const __m128i b = _mm_set1_epi16((short)base);
+        for (; i + 8 <= count; i += 8)
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_add_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i)), b));
+    }
+    else
+    {
+        const __m128i b = _mm_set1_epi32((int)base);
+        for (; i + 4 <= count; i += 4)
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_add_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i)), b));
+    }
+#elif defined(IMNODEFLOW_NEON)
+    if (sizeof(ImDrawIdx) == 2)
+    {
+        const uint16x8_t b = vdupq_n_u16((uint16_t)base);
+        for (; i + 8 <= count; i += 8)
+            vst1q_u16(reinterpret_cast<uint16_t*>(dst + i), vaddq_u16(vld1q_u16(reinterpret_cast<const uint16_t*>(src + i)), b));
+    }
+    else
+    {
+        const uint32x4_t b = vdupq_n_u32(base);
+        for (; i + 4 <= count; i += 4)
+            vst1q_u32(reinterpret_cast<uint32_t*>(dst + i), vaddq_u32(vld1q_u32(reinterpret_cast<const uint32_t*>(src + i)), b));
+    }
+#endif
+    for (; i < count; i++)
+        dst[i] = (ImDrawIdx)(src[i] + base);
+}
+
 inline static void AppendDrawData(ImDrawList* src, ImVec2 origin, float scale)
 {
-    // TODO optimize if vtx_start == 0 || if idx_start == 0
     ImDrawList* dl = ImGui::GetWindowDrawList();
     const int vtx_start = dl->VtxBuffer.size();
     const int idx_start = dl->IdxBuffer.size();
+    // With VtxOffset support the indices can be copied as they are and each command points to its own vertices
+    const bool use_vtx_offset = (ImGui::GetIO().BackendFlags & ImGuiBackendFlags_RendererHasVtxOffset) != 0;
     dl->VtxBuffer.resize(dl->VtxBuffer.size() + src->VtxBuffer.size());
     dl->IdxBuffer.resize(dl->IdxBuffer.size() + src->IdxBuffer.size());
-    dl->CmdBuffer.reserve(dl->CmdBuffer.size() + src->CmdBuffer.size());
+    dl->CmdBuffer.reserve(dl->CmdBuffer.size() + src->CmdBuffer.size() + 1);
     dl->_VtxWritePtr = dl->VtxBuffer.Data + vtx_start;
     dl->_IdxWritePtr = dl->IdxBuffer.Data + idx_start;
-    const ImDrawVert* vtx_read = src->VtxBuffer.Data;
-    const ImDrawIdx* idx_read = src->IdxBuffer.Data;
-    for (int i = 0, c = src->VtxBuffer.size(); i < c; ++i) {
-        dl->_VtxWritePtr[i].uv = vtx_read[i].uv;
-        dl->_VtxWritePtr[i].col = vtx_read[i].col;
-        dl->_VtxWritePtr[i].pos = vtx_read[i].pos * scale + origin;
-    }
-    for (int i = 0, c = src->IdxBuffer.size(); i < c; ++i) {
-        dl->_IdxWritePtr[i] = idx_read[i] + vtx_start;
-    }
+    TransformVertices(dl->_VtxWritePtr, src->VtxBuffer.Data, src->VtxBuffer.size(), origin, scale);
+    RebaseIndices(dl->_IdxWritePtr, src->IdxBuffer.Data, src->IdxBuffer.size(), use_vtx_offset ? 0 : vtx_start);
     for (auto cmd : src->CmdBuffer) {
         cmd.IdxOffset += idx_start;
-        IM_ASSERT(cmd.VtxOffset == 0);
+        if (use_vtx_offset)
+            cmd.VtxOffset += vtx_start;
+        else
+            IM_ASSERT(cmd.VtxOffset == 0);
         cmd.ClipRect.x = cmd.ClipRect.x * scale + origin.x;
         cmd.ClipRect.y = cmd.ClipRect.y * scale + origin.y;
         cmd.ClipRect.z = cmd.ClipRect.z * scale + origin.x;
@@ -50,6 +156,8 @@ inline static void AppendDrawData(ImDrawList* src, ImVec2 origin, float scale)
     dl->_VtxCurrentIdx += src->VtxBuffer.size();
     dl->_VtxWritePtr = dl->VtxBuffer.Data + dl->VtxBuffer.size();
     dl->_IdxWritePtr = dl->IdxBuffer.Data + dl->IdxBuffer.size();
+    // Start a fresh command from the list's own header, so following primitives don't extend a copied one
+    dl->AddDrawCmd();
 }
 
 struct ContainedContextConfig
@@ -65,6 +173,94 @@ struct ContainedContextConfig
     float default_zoom = 1.f;
     ImGuiKey reset_zoom_key = ImGuiKey_R;
     ImGuiMouseButton scroll_button = ImGuiMouseButton_Middle;
+    // Draw straight into the host window instead of a nested context. Only the canvas window's vertices are scaled:
+    // popups, tooltips and child windows opened while drawing the canvas are not zoomed, see suspend()
+    bool direct_render = false;
+};
+
+// Profiled sections of ContainedContext::end()
+enum ContextPhase_
+{
+    ContextPhase_Render,  // ImGui::Render() of the nested context
+    ContextPhase_Compose, // Copy or transform of the canvas vertices into the host window
+    ContextPhase_COUNT
+};
+
+/**
+ * @brief Nested ImGui contexts shared by several ContainedContext
+ * @details Canvases drawn one after the other take a context in begin() and give it back in end(), unless an item is
+ *          active, a popup is open or a mouse button is held in it. The number of contexts then follows the number of
+ *          canvases busy at the same time instead of the number of canvases. Must outlive the canvases using it.
+ */
+class ContainedContextPool
+{
+public:
+    ContainedContextPool() = default;
+    ~ContainedContextPool()
+    {
+        IM_ASSERT(m_lent == 0 && "Canvases still hold contexts of the pool");
+        for (Slot& slot : m_free)
+            ImGui::DestroyContext(slot.ctx);
+    }
+
+    ContainedContextPool(const ContainedContextPool&) = delete;
+    ContainedContextPool& operator=(const ContainedContextPool&) = delete;
+
+    /**
+     * @brief <BR>Take a context, creating one if none is free
+     * @param fonts Font atlas of the host context, shared with new contexts
+     * @param style Set to the style stamp the context was last synced to, 0 for a new one
+     * @return Context last used by another canvas, or a new one
+     */
+    ImGuiContext* acquire(ImFontAtlas* fonts, unsigned& style)
+    {
+        m_lent++;
+        if (m_free.empty())
+        {
+            style = 0;
+            return ImGui::CreateContext(fonts);
+        }
+        Slot slot = m_free.back();
+        m_free.pop_back();
+        style = slot.style;
+        return slot.ctx;
+    }
+
+    /**
+     * @brief <BR>Give a context back
+     * @param ctx Context returned by acquire()
+     * @param style Style stamp the context is synced to
+     */
+    void release(ImGuiContext* ctx, unsigned style)
+    {
+        IM_ASSERT(m_lent > 0);
+        m_lent--;
+        m_free.push_back({ctx, style});
+    }
+
+    /**
+     * @brief <BR>Copy the host style again into every context, each one the next time it is used
+     */
+    void syncStyle() { m_style++; }
+
+    /**
+     * @brief <BR>Get the style stamp the contexts have to be synced to
+     * @return Stamp bumped by syncStyle(), never 0
+     */
+    [[nodiscard]] unsigned styleStamp() const { return m_style; }
+
+    [[nodiscard]] int created() const { return m_lent + m_free.Size; }
+    [[nodiscard]] int lent() const { return m_lent; }
+private:
+    struct Slot
+    {
+        ImGuiContext* ctx;
+        unsigned style;
+    };
+
+    ImVector<Slot> m_free;
+    int m_lent = 0;
+    unsigned m_style = 1;
 };
 
 class ContainedContext
@@ -79,10 +275,68 @@ public:
     [[nodiscard]] const ImVec2& origin() const { return m_origin; }
     [[nodiscard]] bool hovered() const { return m_hovered; }
     [[nodiscard]] const ImVec2& scroll() const { return m_scroll; }
+
+    /**
+     * @brief <BR>Check if the view moved during the last end()
+     * @return [TRUE] if the scroll or zoom changed, or if the zoom is still animating towards its target
+     */
+    [[nodiscard]] bool changed() const { return m_changed; }
     [[nodiscard]] ImVec2 getScreenDelta() { return m_original_ctx->IO.MouseDelta / scale(); }
     ImGuiContext* getRawContext() { return m_ctx; }
+
+    /**
+     * @brief <BR>Draw through contexts of a pool instead of an own context
+     * @details Only used by the nested mode. With a pool the raw context is only valid between begin() and end().
+     * @param pool Pool to take the context from, nullptr to go back to an own context
+     */
+    void setPool(ContainedContextPool* pool);
     void setFontDensity();
+
+    /**
+     * @brief <BR>Copy the host style into the nested context at the next begin()
+     * @details The style is copied when the nested context is created, and afterwards only when this is called.
+     *          Call it after changing the host ImGuiStyle. With a pool, every context of the pool is synced again.
+     */
+    void syncStyle();
+
+    /**
+     * @brief <BR>Check if the current ImGui state is the one of the canvas
+     * @return [TRUE] between begin() and end(), while the canvas coordinates are in use
+     */
+    [[nodiscard]] bool inCanvas() const { return m_direct ? m_inside && !m_suspended : ImGui::GetCurrentContext() == m_ctx; }
+
+    /**
+     * @brief <BR>Origin of the canvas coordinates, as seen from inside the canvas
+     * @return Host screen position of the canvas in direct mode, (0,0) for the nested context
+     */
+    [[nodiscard]] ImVec2 canvasOrigin() const { return m_direct ? m_origin : ImVec2(0.f, 0.f); }
+
+    /**
+     * @brief <BR>Temporarily go back to host coordinates
+     * @details Only meaningful in direct mode while zoomed: restores the real mouse position so that windows
+     *          living outside the canvas (e.g. popups) are placed and hit-tested correctly. No-op otherwise. <BR>
+     *          The editor suspends around its own popups. Popups and tooltips opened by nodes in draw() need the
+     *          same, otherwise they are placed in canvas coordinates. They are never scaled.
+     */
+    void suspend();
+
+    /**
+     * @brief <BR>Resume the canvas coordinates after suspend()
+     */
+    void resume();
+
+    /**
+     * @brief <BR>Get the timing of a section of the last end()
+     * @param phase One of ContextPhase_
+     * @return Time and calls, zero unless IMNODEFLOW_PROFILING is enabled
+     */
+    [[nodiscard]] const ProfileStat& profile(int phase) const { return m_profile[phase]; }
 private:
+    void beginDirect();
+    void endDirect();
+    void endNested();
+    void transformDirect(ImDrawList* dl);
+
     ContainedContextConfig m_config;
 
     ImVec2 m_origin;
@@ -90,6 +344,16 @@ private:
     ImVec2 m_size;
     ImGuiContext* m_ctx = nullptr;
     ImGuiContext* m_original_ctx = nullptr;
+    ContainedContextPool* m_pool = nullptr;
+    unsigned m_style = 1; // Stamp bumped by syncStyle() when not pooled
+    unsigned m_ctxStyle = 0; // Stamp m_ctx is synced to
+
+    bool m_direct = false;
+    bool m_inside = false;
+    bool m_suspended = false;
+    int m_vtxStart = 0;
+    int m_cmdStart = 0;
+    ImVec2 m_hostMousePos;
 
     bool m_anyWindowHovered = false;
     bool m_anyItemActive = false;
@@ -97,11 +361,36 @@ private:
 
     float m_scale = m_config.default_zoom, m_scaleTarget = m_config.default_zoom;
     ImVec2 m_scroll = {0.f, 0.f};
+    bool m_changed = true;
+
+    ProfileStat m_profile[ContextPhase_COUNT];
 };
 
 inline ContainedContext::~ContainedContext()
 {
-    if (m_ctx) ImGui::DestroyContext(m_ctx);
+    setPool(nullptr);
+}
+
+inline void ContainedContext::setPool(ContainedContextPool* pool)
+{
+    IM_ASSERT(!m_original_ctx && "Can't change the pool between begin() and end()");
+    if (m_ctx)
+    {
+        if (m_pool)
+            m_pool->release(m_ctx, m_ctxStyle);
+        else
+            ImGui::DestroyContext(m_ctx);
+        m_ctx = nullptr;
+    }
+    m_pool = pool;
+}
+
+inline void ContainedContext::syncStyle()
+{
+    if (m_pool)
+        m_pool->syncStyle();
+    else
+        m_style++;
 }
 
 // Call after Begin()
@@ -114,9 +403,13 @@ inline void ContainedContext::setFontDensity()
 
 inline void ContainedContext::begin()
 {
+    for (ProfileStat& p : m_profile)
+        p.reset();
     ImGui::PushID(this);
     ImGui::PushStyleColor(ImGuiCol_ChildBg, m_config.color);
-    ImGui::BeginChild("view_port", m_config.size, 0, ImGuiWindowFlags_NoMove);
+    m_direct = m_config.direct_render;
+    ImGui::BeginChild("view_port", m_config.size, 0, m_direct ? ImGuiWindowFlags_NoMove | ImGuiWindowFlags_NoScrollbar | ImGuiWindowFlags_NoScrollWithMouse
+                                                              : ImGuiWindowFlags_NoMove);
     setFontDensity();
     ImGui::PopStyleColor();
     m_pos = ImGui::GetWindowPos();
@@ -124,11 +417,31 @@ inline void ContainedContext::begin()
     m_size = ImGui::GetContentRegionAvail();
     m_origin = ImGui::GetCursorScreenPos();
     m_original_ctx = ImGui::GetCurrentContext();
+    if (m_direct)
+    {
+        beginDirect();
+        return;
+    }
     const ImGuiStyle& orig_style = ImGui::GetStyle();
-    if (!m_ctx) m_ctx = ImGui::CreateContext(ImGui::GetIO().Fonts);
+    if (!m_ctx && m_pool)
+    {
+        // The context may have missed input while idle or serving another canvas, start from the host's state
+        m_ctx = m_pool->acquire(ImGui::GetIO().Fonts, m_ctxStyle);
+        CopyHeldInput(m_original_ctx, m_ctx);
+        m_ctx->IO.MousePos = (m_original_ctx->IO.MousePos - m_origin) / m_scale;
+    }
+    if (!m_ctx)
+    {
+        m_ctx = ImGui::CreateContext(ImGui::GetIO().Fonts);
+        m_ctxStyle = 0;
+    }
     ImGui::SetCurrentContext(m_ctx);
-    ImGuiStyle& new_style = ImGui::GetStyle();
-    new_style = orig_style;
+    const unsigned style = m_pool ? m_pool->styleStamp() : m_style;
+    if (m_ctxStyle != style)
+    {
+        ImGui::GetStyle() = orig_style;
+        m_ctxStyle = style;
+    }
 
     CopyIOEvents(m_original_ctx, m_ctx, m_origin, m_scale);
 
@@ -144,6 +457,7 @@ inline void ContainedContext::begin()
 #endif
 
     ImGui::NewFrame();
+    ImGui::GetIO().IniFilename = nullptr;
 
     if (!m_config.extra_window_wrapper)
         return;
@@ -156,18 +470,97 @@ inline void ContainedContext::begin()
     ImGui::PopStyleVar();
 }
 
-inline void ContainedContext::end()
+inline void ContainedContext::beginDirect()
+{
+    m_inside = true;
+    m_suspended = false;
+    ImDrawList* dl = ImGui::GetWindowDrawList();
+    m_vtxStart = dl->VtxBuffer.Size;
+    if (m_scale == 1.f)
+    {
+        m_cmdStart = dl->CmdBuffer.Size - 1;
+        return;
+    }
+
+    // Lay the canvas out at 1:1 and scale everything once in end()
+    ImGui::PushClipRect(m_origin, m_origin + m_size / m_scale, false);
+    m_cmdStart = dl->CmdBuffer.Size - 1;
+    ImGuiIO& io = ImGui::GetIO();
+    m_hostMousePos = io.MousePos;
+    if (ImGui::IsMousePosValid(&io.MousePos))
+        io.MousePos = (io.MousePos - m_origin) / m_scale + m_origin;
+}
+
+inline void ContainedContext::suspend()
+{
+    if (!m_direct || !m_inside || m_suspended)
+        return;
+    m_suspended = true;
+    if (m_scale == 1.f)
+        return;
+    ImGuiIO& io = ImGui::GetIO();
+    ImSwap(io.MousePos, m_hostMousePos);
+}
+
+inline void ContainedContext::resume()
+{
+    if (!m_direct || !m_inside || !m_suspended)
+        return;
+    m_suspended = false;
+    if (m_scale == 1.f)
+        return;
+    ImGuiIO& io = ImGui::GetIO();
+    ImSwap(io.MousePos, m_hostMousePos);
+}
+
+inline void ContainedContext::transformDirect(ImDrawList* dl)
+{
+    // Everything emitted since beginDirect() sits in a contiguous range, channels merged or not
+    ImDrawVert* vtx = dl->VtxBuffer.Data + m_vtxStart;
+    TransformVertices(vtx, vtx, dl->VtxBuffer.Size - m_vtxStart, m_origin - m_origin * m_scale, m_scale);
+
+    const ImVec4 host = dl->_ClipRectStack.Size > 1 ? dl->_ClipRectStack[dl->_ClipRectStack.Size - 2] : dl->_Data->ClipRectFullscreen;
+    for (int i = m_cmdStart; i < dl->CmdBuffer.Size; i++)
+    {
+        ImVec4& r = dl->CmdBuffer[i].ClipRect;
+        r = ImVec4((r.x - m_origin.x) * m_scale + m_origin.x, (r.y - m_origin.y) * m_scale + m_origin.y,
+                   (r.z - m_origin.x) * m_scale + m_origin.x, (r.w - m_origin.y) * m_scale + m_origin.y);
+        r = ImVec4(ImMax(r.x, host.x), ImMax(r.y, host.y), ImMin(r.z, host.z), ImMin(r.w, host.w));
+    }
+}
+
+inline void ContainedContext::endDirect()
+{
+    resume();
+    m_anyWindowHovered = false;
+    m_anyItemActive = ImGui::IsAnyItemActive();
+    if (m_scale != 1.f)
+    {
+        IMNODEFLOW_PROFILE_SCOPE(m_profile[ContextPhase_Compose]);
+        transformDirect(ImGui::GetWindowDrawList());
+        ImGui::PopClipRect();
+        ImGui::GetIO().MousePos = m_hostMousePos;
+    }
+    m_inside = false;
+    m_original_ctx = nullptr;
+}
+
+inline void ContainedContext::endNested()
 {
     m_anyWindowHovered = ImGui::IsWindowHovered(ImGuiHoveredFlags_AnyWindow);
     if (m_config.extra_window_wrapper && ImGui::IsWindowHovered())
         m_anyWindowHovered = false;
 
     m_anyItemActive = ImGui::IsAnyItemActive();
+    const bool keepContext = !m_pool || m_anyItemActive || ImGui::IsAnyMouseDown() ||
+                             ImGui::IsPopupOpen("", ImGuiPopupFlags_AnyPopupId);
 
     if (m_config.extra_window_wrapper)
         ImGui::End();
 
+    IMNODEFLOW_PROFILE_LAP_BEGIN(lap);
     ImGui::Render();
+    IMNODEFLOW_PROFILE_LAP(lap, m_profile[ContextPhase_Render]);
 
     ImDrawData* draw_data = ImGui::GetDrawData();
 
@@ -177,8 +570,25 @@ inline void ContainedContext::end()
 
     for (int i = 0; i < draw_data->CmdListsCount; ++i)
         AppendDrawData(draw_data->CmdLists[i], m_origin, m_scale);
+    IMNODEFLOW_PROFILE_LAP(lap, m_profile[ContextPhase_Compose]);
+
+    if (!keepContext)
+    {
+        m_pool->release(m_ctx, m_ctxStyle);
+        m_ctx = nullptr;
+    }
+}
+
+inline void ContainedContext::end()
+{
+    if (m_direct)
+        endDirect();
+    else
+        endNested();
 
     m_hovered = ImGui::IsWindowHovered(ImGuiHoveredFlags_ChildWindows) && !m_anyWindowHovered;
+    const ImVec2 prevScroll = m_scroll;
+    const float prevScale = m_scale;
 
     // Zooming
     if (m_config.zoom_enabled && m_hovered && ImGui::GetIO().MouseWheel != 0.f)
@@ -215,7 +625,9 @@ inline void ContainedContext::end()
     {
         m_scroll += ImGui::GetIO().MouseDelta / m_scale;
     }
-    this->m_ctx->IO.MousePos = (ImGui::GetMousePos() - m_origin) / m_scale;
+    m_changed = m_scroll.x != prevScroll.x || m_scroll.y != prevScroll.y || m_scale != prevScale || m_scale != m_scaleTarget;
+    if (!m_direct && m_ctx)
+        this->m_ctx->IO.MousePos = (ImGui::GetMousePos() - m_origin) / m_scale;
     ImGui::EndChild();
     ImGui::PopID();
 }
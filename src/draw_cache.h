@@ -0,0 +1,141 @@
+#pragma once
+
+#include <imgui.h>
+#include <imgui_internal.h>
+#include <string>
+#include "context_wrapper.h"
+
+/**
+ * @brief Recorded block of draw list primitives, replayed with an offset
+ * @details Records the vertices and indices emitted into the current command of a draw list between beginRecord()
+ *          and endRecord(). Replaying copies them back translated, skipping all the path and tessellation work.
+ *          Whether the recording must be redone is up to the owner.
+ */
+class DrawCache
+{
+public:
+    /**
+     * @brief <BR>Start recording
+     * @param dl Draw list the primitives will be emitted into
+     */
+    void beginRecord(ImDrawList* dl)
+    {
+        m_vtxStart = dl->VtxBuffer.Size;
+        m_idxStart = dl->IdxBuffer.Size;
+        m_idxBase = dl->_VtxCurrentIdx;
+        m_vtxOffset = dl->_CmdHeader.VtxOffset;
+        m_cmdCount = dl->CmdBuffer.Size;
+    }
+
+    /**
+     * @brief <BR>Stop recording and keep a copy of what was emitted
+     * @param dl Draw list given to beginRecord()
+     * @param origin Reference point of the recorded primitives
+     * @return [TRUE] if the primitives could be recorded, i.e. they were all added to the same command
+     */
+    bool endRecord(ImDrawList* dl, const ImVec2& origin)
+    {
+        m_valid = dl->_CmdHeader.VtxOffset == m_vtxOffset && dl->CmdBuffer.Size == m_cmdCount;
+        if (!m_valid)
+        {
+            clear();
+            return false;
+        }
+        m_origin = origin;
+        m_vtx.resize(dl->VtxBuffer.Size - m_vtxStart);
+        m_idx.resize(dl->IdxBuffer.Size - m_idxStart);
+        if (!m_vtx.empty())
+            memcpy(m_vtx.Data, dl->VtxBuffer.Data + m_vtxStart, (size_t)m_vtx.Size * sizeof(ImDrawVert));
+        for (int i = 0; i < m_idx.Size; i++)
+            m_idx[i] = (ImDrawIdx)(dl->IdxBuffer[m_idxStart + i] - m_idxBase);
+        return true;
+    }
+
+    /**
+     * @brief <BR>Emit the recorded primitives again
+     * @param dl Destination draw list
+     * @param origin New position of the reference point given to endRecord()
+     */
+    void replay(ImDrawList* dl, const ImVec2& origin) const
+    {
+        if (m_idx.empty())
+            return;
+        dl->PrimReserve(m_idx.Size, m_vtx.Size);
+        TransformVertices(dl->_VtxWritePtr, m_vtx.Data, m_vtx.Size, origin - m_origin, 1.f);
+        RebaseIndices(dl->_IdxWritePtr, m_idx.Data, m_idx.Size, dl->_VtxCurrentIdx);
+        dl->_VtxWritePtr += m_vtx.Size;
+        dl->_IdxWritePtr += m_idx.Size;
+        dl->_VtxCurrentIdx += (unsigned int)m_vtx.Size;
+    }
+
+    /**
+     * @brief <BR>Drop the recording and free its memory
+     */
+    void clear()
+    {
+        m_vtx.clear();
+        m_idx.clear();
+        m_valid = false;
+    }
+
+    [[nodiscard]] bool valid() const { return m_valid; }
+    [[nodiscard]] int vertexCount() const { return m_vtx.Size; }
+private:
+    ImVector<ImDrawVert> m_vtx;
+    ImVector<ImDrawIdx> m_idx;
+    ImVec2 m_origin;
+    bool m_valid = false;
+
+    int m_vtxStart = 0, m_idxStart = 0, m_cmdCount = 0;
+    unsigned int m_idxBase = 0, m_vtxOffset = 0;
+};
+
+/**
+ * @brief Measured size of a text, measured again only when the font or its size change
+ * @details The owner calls reset() when the text itself changes.
+ */
+class TextCache
+{
+public:
+    /**
+     * @brief <BR>Get the size of the text with the current font
+     * @param text Text to be measured, the same every call until reset()
+     * @return Size the text takes once rendered, as given by ImGui::CalcTextSize()
+     */
+    const ImVec2& size(const std::string& text)
+    {
+        ImFont* font = ImGui::GetFont();
+        float fontSize = ImGui::GetFontSize();
+        if (font != m_font || fontSize != m_fontSize)
+        {
+            m_font = font;
+            m_fontSize = fontSize;
+            m_size = ImGui::CalcTextSize(text.data(), text.data() + text.size());
+        }
+        return m_size;
+    }
+
+    /**
+     * @brief <BR>Submit the text as an item at the cursor position, like ImGui::TextUnformatted()
+     * @details Skips the formatting and the measuring of the text.
+     * @param text Text to be drawn, the same every call until reset()
+     * @param col Color of the text
+     */
+    void item(const std::string& text, ImU32 col)
+    {
+        ImVec2 pos = ImGui::GetCursorScreenPos();
+        const ImVec2& sz = size(text);
+        ImGui::ItemSize(sz, 0.f);
+        if (ImGui::ItemAdd(ImRect(pos, pos + sz), 0))
+            ImGui::GetWindowDrawList()->AddText(pos, col, text.data(), text.data() + text.size());
+    }
+
+    /**
+     * @brief <BR>Measure the text again on next use
+     */
+    void reset() { m_font = nullptr; }
+private:
+    ImFont* m_font = nullptr;
+    float m_fontSize = 0.f;
+    ImVec2 m_size;
+};
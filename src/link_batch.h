@@ -0,0 +1,197 @@
+#pragma once
+
+#include <vector>
+#include <imgui.h>
+#include <imgui_internal.h>
+
+/**
+ * @brief Batched renderer for polylines
+ * @details Collects the polylines of all the visible links during a frame and writes them into the draw list
+ *          as one contiguous block of thick lines, with a single PrimReserve() whenever the index type allows it.
+ *          Lines are anti-aliased when the draw list has ImDrawListFlags_AntiAliasedLines.
+ *          Points are referenced, not copied: they must stay alive until render().
+ */
+class LinkBatch
+{
+public:
+    /**
+     * @brief <BR>Queue a polyline
+     * @param points Pointer to the first point
+     * @param count Number of points
+     * @param color Color of the line
+     * @param thickness Thickness of the line
+     */
+    void add(const ImVec2* points, int count, ImU32 color, float thickness)
+    {
+        if (count < 2 || (color & IM_COL32_A_MASK) == 0)
+            return;
+        m_items.push_back({points, count, color, thickness});
+    }
+
+    /**
+     * @brief <BR>Write all the queued polylines into the draw list and clear the queue
+     * @param dl Destination draw list
+     */
+    void render(ImDrawList* dl)
+    {
+        const bool aa = (dl->Flags & ImDrawListFlags_AntiAliasedLines) != 0;
+        const int vtxPerPoint = aa ? 4 : 2, idxPerSegment = aa ? 18 : 6;
+        // With 16-bit indices a reserve can't address more than 64k vertices. Without VtxOffset the indices of
+        // the whole draw list share that range, so the vertices already emitted count too
+        const bool vtxOffset = (dl->Flags & ImDrawListFlags_AllowVtxOffset) != 0;
+        const int maxVtx = sizeof(ImDrawIdx) == 2 ? 0xFFFF : 0x7FFFFFFF;
+        size_t first = 0;
+        while (first < m_items.size())
+        {
+            const int room = sizeof(ImDrawIdx) == 2 && !vtxOffset ? maxVtx - (int)dl->_VtxCurrentIdx : maxVtx;
+            int vtx = 0, idx = 0;
+            size_t last = first;
+            for (; last < m_items.size(); last++)
+            {
+                int v = m_items[last].count * vtxPerPoint;
+                if (vtx + v > room && last > first)
+                    break;
+                vtx += v;
+                idx += (m_items[last].count - 1) * idxPerSegment;
+            }
+            IM_ASSERT(vtx <= room && "Too many vertices for 16-bit indices, use 32-bit ImDrawIdx or a backend with ImGuiBackendFlags_RendererHasVtxOffset");
+            if (aa)
+                write(dl, first, last, vtx, idx);
+            else
+                writeThin(dl, first, last, vtx, idx);
+            first = last;
+        }
+        m_items.clear();
+    }
+
+    [[nodiscard]] size_t size() const { return m_items.size(); }
+    void clear() { m_items.clear(); }
+private:
+    struct Item
+    {
+        const ImVec2* points;
+        int count;
+        ImU32 color;
+        float thickness;
+    };
+
+    /**
+     * @brief <BR>Compute the normal of each segment of a polyline, the last point reuses the last segment's
+     */
+    void computeNormals(const Item& it)
+    {
+        m_normals.resize(it.count);
+        for (int p = 0; p < it.count - 1; p++)
+        {
+            ImVec2 d = it.points[p + 1] - it.points[p];
+            float inv = ImInvLength(d, 1.f);
+            m_normals[p] = ImVec2(d.y * inv, -d.x * inv);
+        }
+        m_normals[it.count - 1] = m_normals[it.count - 2];
+    }
+
+    /**
+     * @brief <BR>Miter between the two segments adjacent to a point, clamped like ImDrawList::AddPolyline()
+     */
+    [[nodiscard]] ImVec2 miter(int p) const
+    {
+        ImVec2 n = m_normals[p];
+        if (p > 0)
+        {
+            n = (m_normals[p - 1] + m_normals[p]) * 0.5f;
+            float d2 = n.x * n.x + n.y * n.y;
+            if (d2 > 0.000001f)
+                n = n * ImMin(1.f / d2, 100.f);
+        }
+        return n;
+    }
+
+    void write(ImDrawList* dl, size_t first, size_t last, int vtxCount, int idxCount)
+    {
+        dl->PrimReserve(idxCount, vtxCount);
+        ImDrawVert* vtx = dl->_VtxWritePtr;
+        ImDrawIdx* idx = dl->_IdxWritePtr;
+        unsigned int base = dl->_VtxCurrentIdx;
+        const ImVec2 uv = dl->_Data->TexUvWhitePixel;
+        const float fringe = dl->_FringeScale;
+
+        for (size_t i = first; i < last; i++)
+        {
+            const Item& it = m_items[i];
+            const ImU32 colTrans = it.color & ~IM_COL32_A_MASK;
+            const float half = ImMax(it.thickness - fringe, 0.f) * 0.5f;
+
+            computeNormals(it);
+            for (int p = 0; p < it.count; p++)
+            {
+                const ImVec2 n = miter(p);
+                const ImVec2 inner = n * half;
+                const ImVec2 outer = n * (half + fringe);
+                const ImVec2& pt = it.points[p];
+                vtx[0] = {pt + outer, uv, colTrans};
+                vtx[1] = {pt + inner, uv, it.color};
+                vtx[2] = {pt - inner, uv, it.color};
+                vtx[3] = {pt - outer, uv, colTrans};
+                vtx += 4;
+
+                if (p == it.count - 1)
+                    continue;
+                const ImDrawIdx a = (ImDrawIdx)base;
+                const ImDrawIdx b = (ImDrawIdx)(base + 4);
+                const ImDrawIdx quads[18] = {
+                    (ImDrawIdx)(b + 1), (ImDrawIdx)(b + 2), (ImDrawIdx)(a + 2), (ImDrawIdx)(a + 2), (ImDrawIdx)(a + 1), (ImDrawIdx)(b + 1),
+                    (ImDrawIdx)(b + 1), (ImDrawIdx)(a + 1), (ImDrawIdx)(a + 0), (ImDrawIdx)(a + 0), (ImDrawIdx)(b + 0), (ImDrawIdx)(b + 1),
+                    (ImDrawIdx)(b + 2), (ImDrawIdx)(a + 2), (ImDrawIdx)(a + 3), (ImDrawIdx)(a + 3), (ImDrawIdx)(b + 3), (ImDrawIdx)(b + 2)};
+                for (ImDrawIdx q : quads)
+                    *idx++ = q;
+                base += 4;
+            }
+            base += 4;
+        }
+
+        dl->_VtxWritePtr = vtx;
+        dl->_IdxWritePtr = idx;
+        dl->_VtxCurrentIdx = base;
+    }
+
+    // Same as write() without the fringe: two vertices per point, one quad per segment
+    void writeThin(ImDrawList* dl, size_t first, size_t last, int vtxCount, int idxCount)
+    {
+        dl->PrimReserve(idxCount, vtxCount);
+        ImDrawVert* vtx = dl->_VtxWritePtr;
+        ImDrawIdx* idx = dl->_IdxWritePtr;
+        unsigned int base = dl->_VtxCurrentIdx;
+        const ImVec2 uv = dl->_Data->TexUvWhitePixel;
+
+        for (size_t i = first; i < last; i++)
+        {
+            const Item& it = m_items[i];
+            const float half = it.thickness * 0.5f;
+            computeNormals(it);
+            for (int p = 0; p < it.count; p++)
+            {
+                const ImVec2 d = miter(p) * half;
+                const ImVec2& pt = it.points[p];
+                vtx[0] = {pt + d, uv, it.color};
+                vtx[1] = {pt - d, uv, it.color};
+                vtx += 2;
+
+                if (p == it.count - 1)
+                    continue;
+                const ImDrawIdx quad[6] = {(ImDrawIdx)base, (ImDrawIdx)(base + 1), (ImDrawIdx)(base + 3),
+                                           (ImDrawIdx)base, (ImDrawIdx)(base + 3), (ImDrawIdx)(base + 2)};
+                for (ImDrawIdx q : quad)
+                    *idx++ = q;
+                base += 2;
+            }
+            base += 2;
+        }
+
+        dl->_VtxWritePtr = vtx;
+        dl->_IdxWritePtr = idx;
+        dl->_VtxCurrentIdx = base;
+    }
+
+    std::vector<Item> m_items;
+    std::vector<ImVec2> m_normals;
+};
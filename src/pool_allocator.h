@@ -0,0 +1,112 @@
+#pragma once
+
+#include <new>
+#include <mutex>
+#include <cstddef>
+#include <vector>
+
+/**
+ * @brief Free-list pool of fixed-size blocks
+ * @details Blocks are carved out of big chunks and recycled through an intrusive free list. Chunks are only given
+ *          back to the system when the pool is destroyed.
+ * @tparam Size Size of the blocks
+ * @tparam Align Alignment of the blocks
+ */
+template<size_t Size, size_t Align>
+class FixedPool
+{
+public:
+    /// @brief Number of blocks allocated at once
+    static constexpr size_t BlocksPerChunk = 256;
+
+    ~FixedPool()
+    {
+        for (void* c : m_chunks)
+            ::operator delete(c, std::align_val_t(BlockAlign));
+    }
+
+    /**
+     * @brief <BR>Get the pool shared by all the allocations of this size
+     * @return Reference to the global pool
+     */
+    static FixedPool& instance()
+    {
+        // Never destroyed: pooled objects owned by other statics may outlive it
+        static FixedPool* pool = new FixedPool();
+        return *pool;
+    }
+
+    void* allocate()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!m_free)
+            grow();
+        Node* n = m_free;
+        m_free = n->next;
+        return n;
+    }
+
+    void deallocate(void* p)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        Node* n = static_cast<Node*>(p);
+        n->next = m_free;
+        m_free = n;
+    }
+private:
+    struct Node { Node* next; };
+
+    static constexpr size_t BlockAlign = Align < alignof(Node) ? alignof(Node) : Align;
+    static constexpr size_t BlockSize = ((Size < sizeof(Node) ? sizeof(Node) : Size) + BlockAlign - 1) / BlockAlign * BlockAlign;
+
+    void grow()
+    {
+        char* chunk = static_cast<char*>(::operator new(BlockSize * BlocksPerChunk, std::align_val_t(BlockAlign)));
+        m_chunks.push_back(chunk);
+        // Linked back to front so that blocks are handed out in address order
+        for (size_t i = BlocksPerChunk; i-- > 0;)
+        {
+            Node* n = reinterpret_cast<Node*>(chunk + i * BlockSize);
+            n->next = m_free;
+            m_free = n;
+        }
+    }
+
+    std::mutex m_mutex;
+    Node* m_free = nullptr;
+    std::vector<void*> m_chunks;
+};
+
+/**
+ * @brief Standard allocator drawing single objects from a FixedPool
+ * @details Meant for std::allocate_shared(): the rebound allocator places object and control block in one pooled
+ *          block. Array allocations fall back to the global operator new.
+ * @tparam T Type of the allocated objects
+ */
+template<typename T>
+class PoolAllocator
+{
+public:
+    using value_type = T;
+
+    PoolAllocator() noexcept = default;
+    template<typename U> PoolAllocator(const PoolAllocator<U>&) noexcept {}
+
+    T* allocate(size_t n)
+    {
+        if (n == 1)
+            return static_cast<T*>(FixedPool<sizeof(T), alignof(T)>::instance().allocate());
+        return static_cast<T*>(::operator new(n * sizeof(T), std::align_val_t(alignof(T))));
+    }
+
+    void deallocate(T* p, size_t n) noexcept
+    {
+        if (n == 1)
+            FixedPool<sizeof(T), alignof(T)>::instance().deallocate(p);
+        else
+            ::operator delete(p, std::align_val_t(alignof(T)));
+    }
+
+    template<typename U> bool operator==(const PoolAllocator<U>&) const noexcept { return true; }
+    template<typename U> bool operator!=(const PoolAllocator<U>&) const noexcept { return false; }
+};
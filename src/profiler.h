@@ -0,0 +1,72 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+
+// Define to 1 to compile the timers in. When 0 they expand to nothing and all the timings stay at zero
+#ifndef IMNODEFLOW_PROFILING
+#define IMNODEFLOW_PROFILING 0
+#endif
+
+/**
+ * @brief Accumulated time and call count of a profiled section
+ * @details Present whether profiling is enabled or not, so that the layout of the classes holding them doesn't
+ *          depend on the macro.
+ */
+struct ProfileStat
+{
+    double seconds = 0.0;
+    double last = 0.0;
+    uint32_t calls = 0;
+
+    void add(double s) { seconds += s; last = s; calls++; }
+    void reset() { seconds = 0.0; last = 0.0; calls = 0; }
+};
+
+/**
+ * @brief Timer adding its lifetime to a ProfileStat
+ */
+class ProfileScope
+{
+public:
+    explicit ProfileScope(ProfileStat& stat) : m_stat(stat), m_start(std::chrono::steady_clock::now()) {}
+    ~ProfileScope() { m_stat.add(std::chrono::duration<double>(std::chrono::steady_clock::now() - m_start).count()); }
+
+    ProfileScope(const ProfileScope&) = delete;
+    ProfileScope& operator=(const ProfileScope&) = delete;
+private:
+    ProfileStat& m_stat;
+    std::chrono::steady_clock::time_point m_start;
+};
+
+/**
+ * @brief Timer splitting a sequence of sections
+ * @details Each lap() adds the time elapsed since the previous one (or since construction) to a ProfileStat.
+ */
+class ProfileLap
+{
+public:
+    ProfileLap() : m_last(std::chrono::steady_clock::now()) {}
+
+    void lap(ProfileStat& stat)
+    {
+        auto now = std::chrono::steady_clock::now();
+        stat.add(std::chrono::duration<double>(now - m_last).count());
+        m_last = now;
+    }
+private:
+    std::chrono::steady_clock::time_point m_last;
+};
+
+#define IMNODEFLOW_PROFILE_CAT_(a, b) a##b
+#define IMNODEFLOW_PROFILE_CAT(a, b) IMNODEFLOW_PROFILE_CAT_(a, b)
+
+#if IMNODEFLOW_PROFILING
+#define IMNODEFLOW_PROFILE_SCOPE(stat) ProfileScope IMNODEFLOW_PROFILE_CAT(profileScope, __LINE__)(stat)
+#define IMNODEFLOW_PROFILE_LAP_BEGIN(name) ProfileLap name
+#define IMNODEFLOW_PROFILE_LAP(name, stat) name.lap(stat)
+#else
+#define IMNODEFLOW_PROFILE_SCOPE(stat) ((void)0)
+#define IMNODEFLOW_PROFILE_LAP_BEGIN(name) ((void)0)
+#define IMNODEFLOW_PROFILE_LAP(name, stat) ((void)0)
+#endif
@@ -0,0 +1,206 @@
+#pragma once
+
+#include <cstdint>
+#include <tuple>
+#include <vector>
+#include <utility>
+#include <algorithm>
+
+/**
+ * @brief Dense storage addressed through generational handles
+ * @details Values live in a contiguous array in insertion order, erasing keeps the order of the others.
+ *          A handle packs a slot index (low 32 bits) and the generation of the slot (high 32 bits), so handles
+ *          of erased values never alias new ones. Extra per-value columns are stored SoA, aligned with the values.
+ *          Iterating yields pairs of (handle, value) like a std::map.
+ * @tparam T Type of the values
+ * @tparam Columns Types of the side columns
+ */
+template<typename T, typename... Columns>
+class SlotMap
+{
+public:
+    using Handle = uint64_t;
+    using Entry = std::pair<Handle, T>;
+    using iterator = typename std::vector<Entry>::iterator;
+    using const_iterator = typename std::vector<Entry>::const_iterator;
+
+    /**
+     * @brief <BR>Insert a value at the end
+     * @param value Value to be stored
+     * @return Handle of the value, never 0
+     */
+    Handle insert(T value)
+    {
+        uint32_t slot;
+        if (!m_free.empty())
+        {
+            slot = m_free.back();
+            m_free.pop_back();
+        }
+        else
+        {
+            slot = (uint32_t)m_slots.size();
+            m_slots.push_back({0, 0});
+        }
+        Slot& s = m_slots[slot];
+        s.generation++;
+        s.dense = (uint32_t)m_dense.size();
+        Handle h = ((Handle)s.generation << 32) | slot;
+        m_dense.emplace_back(h, std::move(value));
+        pushColumns(std::index_sequence_for<Columns...>{});
+        return h;
+    }
+
+    /**
+     * @brief <BR>Get the position of a value in the dense array
+     * @param h Handle of the value
+     * @return Dense index, or size() if the handle is not valid
+     */
+    [[nodiscard]] size_t indexOf(Handle h) const
+    {
+        uint32_t slot = (uint32_t)(h & 0xFFFFFFFFu);
+        if (slot >= m_slots.size() || m_slots[slot].generation != (uint32_t)(h >> 32) || m_slots[slot].dense == Free)
+            return m_dense.size();
+        return m_slots[slot].dense;
+    }
+
+    [[nodiscard]] bool contains(Handle h) const { return indexOf(h) != m_dense.size(); }
+    [[nodiscard]] size_t count(Handle h) const { return contains(h) ? 1 : 0; }
+
+    iterator find(Handle h) { return m_dense.begin() + (std::ptrdiff_t)indexOf(h); }
+    const_iterator find(Handle h) const { return m_dense.begin() + (std::ptrdiff_t)indexOf(h); }
+
+    /**
+     * @brief <BR>Erase all the values matching a predicate, keeping the order of the others
+     * @details Erased values are destroyed after the storage is consistent again, so their destructors can
+     *          safely access it.
+     * @param pred Predicate called with each (handle, value) pair
+     * @return Number of erased values
+     */
+    template<typename Pred>
+    size_t eraseIf(Pred pred)
+    {
+        std::vector<T> graveyard;
+        size_t out = 0;
+        for (size_t i = 0; i < m_dense.size(); i++)
+        {
+            if (pred(m_dense[i]))
+            {
+                release(m_dense[i].first);
+                graveyard.emplace_back(std::move(m_dense[i].second));
+                continue;
+            }
+            if (out != i)
+            {
+                m_dense[out] = std::move(m_dense[i]);
+                moveColumns(i, out, std::index_sequence_for<Columns...>{});
+            }
+            m_slots[(uint32_t)(m_dense[out].first & 0xFFFFFFFFu)].dense = (uint32_t)out;
+            out++;
+        }
+        size_t erased = m_dense.size() - out;
+        m_dense.resize(out);
+        resizeColumns(out, std::index_sequence_for<Columns...>{});
+        return erased;
+    }
+
+    /**
+     * @brief <BR>Erase a value
+     * @param h Handle of the value
+     * @return [TRUE] if the handle was valid
+     */
+    bool erase(Handle h)
+    {
+        if (!contains(h))
+            return false;
+        eraseIf([h](const Entry& e) { return e.first == h; });
+        return true;
+    }
+
+    /**
+     * @brief <BR>Erase a value
+     * @param it Iterator to the value
+     * @return Iterator to the value that followed the erased one
+     */
+    iterator erase(iterator it)
+    {
+        size_t idx = (size_t)(it - m_dense.begin());
+        erase(it->first);
+        return m_dense.begin() + (std::ptrdiff_t)idx;
+    }
+
+    /**
+     * @brief <BR>Get a side column
+     * @tparam I Index of the column
+     * @return Reference to the column, aligned with the dense array
+     */
+    template<size_t I>
+    auto& column() { return std::get<I>(m_columns); }
+
+    template<size_t I>
+    const auto& column() const { return std::get<I>(m_columns); }
+
+    T& at(Handle h) { return m_dense[indexOf(h)].second; }
+    Entry& operator[](size_t i) { return m_dense[i]; }
+    const Entry& operator[](size_t i) const { return m_dense[i]; }
+
+    /**
+     * @brief <BR>Make room for more values
+     * @param n Total number of values
+     */
+    void reserve(size_t n)
+    {
+        m_dense.reserve(n);
+        m_slots.reserve(n);
+        reserveColumns(n, std::index_sequence_for<Columns...>{});
+    }
+
+    [[nodiscard]] size_t size() const { return m_dense.size(); }
+    [[nodiscard]] bool empty() const { return m_dense.empty(); }
+
+    void clear()
+    {
+        std::vector<Entry> dense = std::move(m_dense);
+        m_dense.clear();
+        for (auto& e : dense)
+            release(e.first);
+        resizeColumns(0, std::index_sequence_for<Columns...>{});
+    }
+
+    iterator begin() { return m_dense.begin(); }
+    iterator end() { return m_dense.end(); }
+    const_iterator begin() const { return m_dense.begin(); }
+    const_iterator end() const { return m_dense.end(); }
+private:
+    static constexpr uint32_t Free = 0xFFFFFFFFu;
+
+    struct Slot
+    {
+        uint32_t dense;
+        uint32_t generation;
+    };
+
+    void release(Handle h)
+    {
+        uint32_t slot = (uint32_t)(h & 0xFFFFFFFFu);
+        m_slots[slot].dense = Free;
+        m_free.push_back(slot);
+    }
+
+    template<size_t... I>
+    void pushColumns(std::index_sequence<I...>) { (std::get<I>(m_columns).emplace_back(), ...); }
+
+    template<size_t... I>
+    void moveColumns(size_t from, size_t to, std::index_sequence<I...>) { ((std::get<I>(m_columns)[to] = std::move(std::get<I>(m_columns)[from])), ...); }
+
+    template<size_t... I>
+    void reserveColumns(size_t n, std::index_sequence<I...>) { (std::get<I>(m_columns).reserve(n), ...); }
+
+    template<size_t... I>
+    void resizeColumns(size_t n, std::index_sequence<I...>) { (std::get<I>(m_columns).resize(n), ...); }
+
+    std::vector<Entry> m_dense;
+    std::tuple<std::vector<Columns>...> m_columns;
+    std::vector<Slot> m_slots;
+    std::vector<uint32_t> m_free;
+};
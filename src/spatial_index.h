@@ -0,0 +1,224 @@
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include <vector>
+#include <unordered_map>
+#include <algorithm>
+#include <imgui.h>
+#include <imgui_internal.h>
+
+/**
+ * @brief Uniform grid spatial hash over axis-aligned rectangles
+ * @details Each item is stored in every cell its rectangle touches. Moving an item only touches the hash map when
+ *          the range of covered cells changes. Items covering too many cells are kept in a separate list that is
+ *          always tested, which keeps long links from flooding the grid.
+ * @tparam T Handle type of the items (usually a pointer)
+ */
+template<typename T>
+class SpatialIndex
+{
+public:
+    explicit SpatialIndex(float cellSize = 50.f) : m_cellSize(cellSize) {}
+
+    /**
+     * @brief <BR>Change the size of the cells
+     * @details Re-inserts all the items, only call when the grid size actually changes.
+     * @param cellSize New cell size
+     */
+    void setCellSize(float cellSize)
+    {
+        if (cellSize <= 0.f || cellSize == m_cellSize)
+            return;
+        m_cellSize = cellSize;
+        m_cells.clear();
+        m_oversized.clear();
+        for (auto& e : m_entries)
+        {
+            computeRange(e.second.rect, e.second);
+            link(e.first, e.second);
+        }
+    }
+
+    [[nodiscard]] float cellSize() const { return m_cellSize; }
+
+    /**
+     * @brief <BR>Insert an item or update its rectangle
+     * @param item Item handle
+     * @param rect New bounding rectangle of the item
+     */
+    void update(T item, const ImRect& rect)
+    {
+        auto it = m_entries.find(item);
+        if (it == m_entries.end())
+        {
+            Entry e;
+            e.rect = rect;
+            computeRange(rect, e);
+            link(item, e);
+            m_entries.emplace(item, e);
+            return;
+        }
+
+        Entry range;
+        computeRange(rect, range);
+        it->second.rect = rect;
+        if (range.x0 == it->second.x0 && range.y0 == it->second.y0 && range.x1 == it->second.x1 && range.y1 == it->second.y1)
+            return;
+        unlink(item, it->second);
+        it->second.x0 = range.x0; it->second.y0 = range.y0;
+        it->second.x1 = range.x1; it->second.y1 = range.y1;
+        link(item, it->second);
+    }
+
+    /**
+     * @brief <BR>Remove an item
+     * @param item Item handle
+     */
+    void remove(T item)
+    {
+        auto it = m_entries.find(item);
+        if (it == m_entries.end())
+            return;
+        unlink(item, it->second);
+        m_entries.erase(it);
+    }
+
+    /**
+     * @brief <BR>Collect all the items whose rectangle contains a point
+     * @param p Point to be tested
+     * @param out Output list, cleared before being filled
+     */
+    void query(const ImVec2& p, std::vector<T>& out) const
+    {
+        out.clear();
+        auto cell = m_cells.find(key(cellCoord(p.x), cellCoord(p.y)));
+        if (cell != m_cells.end())
+            for (const T& item : cell->second)
+                if (contains(m_entries.at(item).rect, p))
+                    out.push_back(item);
+        for (const T& item : m_oversized)
+            if (contains(m_entries.at(item).rect, p))
+                out.push_back(item);
+    }
+
+    /**
+     * @brief <BR>Collect all the items whose rectangle overlaps the given one
+     * @param r Rectangle to be tested
+     * @param out Output list, cleared before being filled
+     */
+    void query(const ImRect& r, std::vector<T>& out) const
+    {
+        out.clear();
+        Entry range;
+        computeRange(r, range);
+        // Walking more cells than there are items costs more than testing them all
+        if ((long long)(range.x1 - range.x0 + 1) * (long long)(range.y1 - range.y0 + 1) > (long long)m_entries.size())
+        {
+            for (const auto& e : m_entries)
+                if (e.second.rect.Overlaps(r))
+                    out.push_back(e.first);
+            return;
+        }
+        for (int y = range.y0; y <= range.y1; y++)
+            for (int x = range.x0; x <= range.x1; x++)
+            {
+                auto cell = m_cells.find(key(x, y));
+                if (cell == m_cells.end())
+                    continue;
+                for (const T& item : cell->second)
+                {
+                    const Entry& e = m_entries.at(item);
+                    // Report each item only in the first cell shared with the query
+                    if (std::max(e.x0, range.x0) == x && std::max(e.y0, range.y0) == y && e.rect.Overlaps(r))
+                        out.push_back(item);
+                }
+            }
+        for (const T& item : m_oversized)
+            if (m_entries.at(item).rect.Overlaps(r))
+                out.push_back(item);
+    }
+
+    /**
+     * @brief <BR>Check if a point is inside any item
+     * @param p Point to be tested
+     * @return [TRUE] if at least one rectangle contains the point
+     */
+    [[nodiscard]] bool any(const ImVec2& p) const
+    {
+        auto cell = m_cells.find(key(cellCoord(p.x), cellCoord(p.y)));
+        if (cell != m_cells.end())
+            for (const T& item : cell->second)
+                if (contains(m_entries.at(item).rect, p))
+                    return true;
+        return std::any_of(m_oversized.begin(), m_oversized.end(), [&](const T& item) { return contains(m_entries.at(item).rect, p); });
+    }
+
+    void clear() { m_entries.clear(); m_cells.clear(); m_oversized.clear(); }
+    [[nodiscard]] size_t size() const { return m_entries.size(); }
+private:
+    /// @brief Past this number of cells an item is stored in the oversized list, queries aren't limited
+    static constexpr int MaxCellsPerItem = 64;
+
+    struct Entry
+    {
+        ImRect rect;
+        int x0 = 0, y0 = 0, x1 = -1, y1 = -1;
+        bool oversized = false;
+    };
+
+    static bool contains(const ImRect& r, const ImVec2& p) { return p.x >= r.Min.x && p.y >= r.Min.y && p.x <= r.Max.x && p.y <= r.Max.y; }
+    static uint64_t key(int x, int y) { return ((uint64_t)(uint32_t)x << 32) | (uint64_t)(uint32_t)y; }
+    [[nodiscard]] int cellCoord(float v) const { return (int)std::floor(v / m_cellSize); }
+
+    void computeRange(const ImRect& r, Entry& e) const
+    {
+        e.x0 = cellCoord(r.Min.x); e.y0 = cellCoord(r.Min.y);
+        e.x1 = cellCoord(r.Max.x); e.y1 = cellCoord(r.Max.y);
+        e.oversized = (long long)(e.x1 - e.x0 + 1) * (long long)(e.y1 - e.y0 + 1) > MaxCellsPerItem;
+    }
+
+    void link(T item, Entry& e)
+    {
+        if (e.oversized)
+        {
+            m_oversized.push_back(item);
+            return;
+        }
+        for (int y = e.y0; y <= e.y1; y++)
+            for (int x = e.x0; x <= e.x1; x++)
+                m_cells[key(x, y)].push_back(item);
+    }
+
+    void unlink(T item, Entry& e)
+    {
+        auto drop = [&item](std::vector<T>& v)
+        {
+            auto it = std::find(v.begin(), v.end(), item);
+            if (it == v.end())
+                return;
+            *it = v.back();
+            v.pop_back();
+        };
+        if (e.oversized)
+        {
+            drop(m_oversized);
+            return;
+        }
+        for (int y = e.y0; y <= e.y1; y++)
+            for (int x = e.x0; x <= e.x1; x++)
+            {
+                auto cell = m_cells.find(key(x, y));
+                if (cell == m_cells.end())
+                    continue;
+                drop(cell->second);
+                if (cell->second.empty())
+                    m_cells.erase(cell);
+            }
+    }
+
+    float m_cellSize;
+    std::unordered_map<T, Entry> m_entries;
+    std::unordered_map<uint64_t, std::vector<T>> m_cells;
+    std::vector<T> m_oversized;
+};
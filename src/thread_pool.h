@@ -0,0 +1,300 @@
+#pragma once
+
+#include <atomic>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <memory>
+#include <vector>
+#include <functional>
+#include <condition_variable>
+
+/**
+ * @brief Work-stealing pool of worker threads
+ * @details Each worker owns a queue of task indices: it pops from the back of its own queue and steals from the front
+ *          of the others once it runs dry. The calling thread takes part in the work too. Threads are only started
+ *          on the first parallelFor() call.
+ */
+class ThreadPool
+{
+public:
+    /**
+     * @brief <BR>Pool constructor
+     * @param threads Number of threads doing the work, calling thread included. 0 picks the hardware concurrency
+     */
+    explicit ThreadPool(unsigned threads = 0) : m_threadCount(threads) {}
+
+    ~ThreadPool() { stop(); }
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    /**
+     * @brief <BR>Change the number of threads
+     * @details Running workers are joined and restarted on the next parallelFor().
+     * @param threads Number of threads doing the work, calling thread included. 0 picks the hardware concurrency
+     */
+    void setThreadCount(unsigned threads)
+    {
+        if (threads == m_threadCount)
+            return;
+        stop();
+        m_threadCount = threads;
+    }
+
+    /**
+     * @brief <BR>Get the number of threads
+     * @return Number of threads doing the work, calling thread included
+     */
+    [[nodiscard]] unsigned threadCount() const
+    {
+        if (m_threadCount != 0)
+            return m_threadCount;
+        unsigned hw = std::thread::hardware_concurrency();
+        return hw == 0 ? 1 : hw;
+    }
+
+    /**
+     * @brief <BR>Run a function for each index in [0, count) and wait for all of them
+     * @param count Number of tasks
+     * @param func Function called with the index of the task, from any thread
+     */
+    void parallelFor(size_t count, const std::function<void(size_t)>& func)
+    {
+        if (count == 0)
+            return;
+        if (count == 1 || threadCount() == 1)
+        {
+            for (size_t i = 0; i < count; i++)
+                func(i);
+            return;
+        }
+        start();
+
+        m_job = &func;
+        m_remaining.store(count);
+        for (size_t i = 0; i < count; i++)
+        {
+            Queue& q = *m_queues[i % m_queues.size()];
+            std::lock_guard<std::mutex> lock(q.mutex);
+            q.items.push_back(i);
+        }
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_generation++;
+        }
+        m_wake.notify_all();
+
+        const size_t self = m_queues.size() - 1;
+        while (runOne(self)) {}
+
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_done.wait(lock, [this]() { return m_remaining.load() == 0; });
+    }
+private:
+    struct Queue
+    {
+        std::mutex mutex;
+        std::deque<size_t> items;
+    };
+
+    void start()
+    {
+        if (!m_threads.empty())
+            return;
+        unsigned workers = threadCount() - 1;
+        m_stop = false;
+        m_queues.clear();
+        for (unsigned i = 0; i <= workers; i++)
+            m_queues.emplace_back(std::make_unique<Queue>());
+        for (unsigned i = 0; i < workers; i++)
+            m_threads.emplace_back([this, i]() { workerLoop(i); });
+    }
+
+    void stop()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stop = true;
+        }
+        m_wake.notify_all();
+        for (auto& t : m_threads)
+            t.join();
+        m_threads.clear();
+    }
+
+    void workerLoop(size_t self)
+    {
+        size_t seen = 0;
+        while (true)
+        {
+            {
+                std::unique_lock<std::mutex> lock(m_mutex);
+                m_wake.wait(lock, [&]() { return m_stop || m_generation != seen; });
+                if (m_stop)
+                    return;
+                seen = m_generation;
+            }
+            while (runOne(self)) {}
+        }
+    }
+
+    bool pop(size_t queue, bool own, size_t& item)
+    {
+        Queue& q = *m_queues[queue];
+        std::lock_guard<std::mutex> lock(q.mutex);
+        if (q.items.empty())
+            return false;
+        if (own)
+        {
+            item = q.items.back();
+            q.items.pop_back();
+        }
+        else
+        {
+            item = q.items.front();
+            q.items.pop_front();
+        }
+        return true;
+    }
+
+    bool runOne(size_t self)
+    {
+        size_t item = 0;
+        bool found = pop(self, true, item);
+        for (size_t i = 1; !found && i < m_queues.size(); i++)
+            found = pop((self + i) % m_queues.size(), false, item);
+        if (!found)
+            return false;
+
+        // The job is published before its items, so popping one makes it visible
+        (*m_job)(item);
+        if (m_remaining.fetch_sub(1) == 1)
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_done.notify_all();
+        }
+        return true;
+    }
+
+    unsigned m_threadCount;
+    std::vector<std::thread> m_threads;
+    std::vector<std::unique_ptr<Queue>> m_queues;
+
+    std::mutex m_mutex;
+    std::condition_variable m_wake, m_done;
+    size_t m_generation = 0;
+    bool m_stop = false;
+
+    const std::function<void(size_t)>* m_job = nullptr;
+    std::atomic<size_t> m_remaining{0};
+};
+
+/**
+ * @brief Background executor for fire-and-forget tasks
+ * @details Tasks are run in submission order by a fixed set of threads, started on the first submit().
+ *          Queued tasks that didn't start yet are dropped on destruction, running ones are waited for.
+ */
+class AsyncExecutor
+{
+public:
+    /**
+     * @brief <BR>Executor constructor
+     * @param threads Number of background threads
+     */
+    explicit AsyncExecutor(unsigned threads = 1) : m_threadCount(threads == 0 ? 1 : threads) {}
+
+    ~AsyncExecutor() { stop(); }
+
+    AsyncExecutor(const AsyncExecutor&) = delete;
+    AsyncExecutor& operator=(const AsyncExecutor&) = delete;
+
+    /**
+     * @brief <BR>Change the number of threads
+     * @details Waits for the running tasks, queued ones are kept.
+     * @param threads Number of background threads
+     */
+    void setThreadCount(unsigned threads)
+    {
+        threads = threads == 0 ? 1 : threads;
+        if (threads == m_threadCount)
+            return;
+        std::deque<std::function<void()>> queued;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            queued.swap(m_tasks);
+        }
+        stop();
+        m_threadCount = threads;
+        if (queued.empty())
+            return;
+        start();
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_tasks.swap(queued);
+        }
+        m_wake.notify_all();
+    }
+
+    [[nodiscard]] unsigned threadCount() const { return m_threadCount; }
+
+    /**
+     * @brief <BR>Queue a task
+     * @param task Function run on one of the background threads
+     */
+    void submit(std::function<void()> task)
+    {
+        start();
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_tasks.push_back(std::move(task));
+        }
+        m_wake.notify_one();
+    }
+private:
+    void start()
+    {
+        if (!m_threads.empty())
+            return;
+        m_stop = false;
+        for (unsigned i = 0; i < m_threadCount; i++)
+            m_threads.emplace_back([this]() { workerLoop(); });
+    }
+
+    void stop()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stop = true;
+            m_tasks.clear();
+        }
+        m_wake.notify_all();
+        for (auto& t : m_threads)
+            t.join();
+        m_threads.clear();
+    }
+
+    void workerLoop()
+    {
+        while (true)
+        {
+            std::function<void()> task;
+            {
+                std::unique_lock<std::mutex> lock(m_mutex);
+                m_wake.wait(lock, [this]() { return m_stop || !m_tasks.empty(); });
+                if (m_stop)
+                    return;
+                task = std::move(m_tasks.front());
+                m_tasks.pop_front();
+            }
+            task();
+        }
+    }
+
+    unsigned m_threadCount;
+    std::vector<std::thread> m_threads;
+    std::deque<std::function<void()>> m_tasks;
+    std::mutex m_mutex;
+    std::condition_variable m_wake;
+    bool m_stop = false;
+};